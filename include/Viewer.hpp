@@ -18,8 +18,9 @@ private:
     sf::View view;          
 
     // Данные задачи
-    std::shared_ptr<Grid> grid;
+    std::shared_ptr<const Grid> grid;
     std::vector<Bundle> bundles;
+    Assignment assignment;
     std::map<int, sf::Color> bundleColors; // Кэш цветов для быстрого доступа
     
     // Состояние интерфейса
@@ -3,6 +3,7 @@
 #include <string>
 #include <memory>
 #include <map>
+#include <algorithm>
 #include "graph.hpp"
 
 enum class GridType {
@@ -11,6 +12,16 @@ enum class GridType {
     TRIANGLE  // 3 соседа
 };
 
+// Нумерация клеток сетки. ROW_MAJOR - по строкам (id = y * width + x); MORTON и HILBERT -
+// вдоль кривой Z-order / Гильберта, так что близкие на плоскости клетки близки и по id.
+// По id индексируются узлы сетки, решения и маски занятости, поэтому обход фигуры
+// или соседей клетки остается в нескольких строках кэша, а не прыгает через строку поля.
+enum class NodeOrder {
+    ROW_MAJOR,
+    MORTON,
+    HILBERT
+};
+
 struct Color {
     int r, g, b;
 };
@@ -26,13 +37,29 @@ public:
     Figure(std::string n, int mp) : Graph<FigureNodeData>(mp), name(n) {}
 };
 
-// Данные для ячейки поля
+// Данные для ячейки поля (только топология: решение хранится отдельно, в Assignment)
 struct GridCellData {
     int x, y;        // Координаты
-    int bundle_id;   // к какой группе пренадлежит(нужно для отрисовки цвета)
-    int figure_id;   // к какой фигуре в группе пренадлежит
     
-    GridCellData(int x = 0, int y = 0) : x(x), y(y), bundle_id(-1), figure_id(-1) {}
+    GridCellData(int x = 0, int y = 0) : x(x), y(y) {}
+};
+
+// Решение на поле: для каждой клетки (по id узла) - бандл и фигура, -1 - клетка свободна.
+// Сетка после загрузки не меняется и разделяется между решениями и потоками,
+// а каждое решение - это только эти два массива.
+struct Assignment {
+    std::vector<int> bundle_id;  // к какой группе пренадлежит(нужно для отрисовки цвета)
+    std::vector<int> figure_id;  // к какой фигуре в группе пренадлежит
+
+    Assignment() = default;
+    explicit Assignment(size_t cells) : bundle_id(cells, -1), figure_id(cells, -1) {}
+
+    size_t size() const { return bundle_id.size(); }
+
+    void clear() {
+        std::fill(bundle_id.begin(), bundle_id.end(), -1);
+        std::fill(figure_id.begin(), figure_id.end(), -1);
+    }
 };
 
 /*
@@ -44,6 +71,8 @@ class Grid : public Graph<GridCellData> {
 private:
     int width, height; // Размеры
     GridType type;     // Тип
+    NodeOrder order = NodeOrder::ROW_MAJOR;
+    std::vector<int> id_at; // (y * width + x) -> id; пусто, если нумерация по строкам
 
     static size_t get_max_ports_for_type(GridType t) {
         switch (t) {
@@ -61,15 +90,30 @@ public:
     int get_width() const { return width; }
     int get_height() const { return height; }
     GridType get_type() const { return type; }
+    NodeOrder get_node_order() const { return order; }
 
     // Возвращает ID узла или -1, если координаты выходят за границы.
     int get_node_id_at(int x, int y) const {
         if (x < 0 || x >= width || y < 0 || y >= height) return -1;
+        if (!id_at.empty()) return id_at[(size_t)y * width + x];
         return y * width + x;
     }
 
+    // Номера клеток width x height в порядке order: результат[y * width + x] - id клетки
+    static std::vector<int> make_numbering(NodeOrder order, int width, int height);
+
+    // Запоминает нумерацию и строит таблицу для get_node_id_at по координатам узлов
+    // (вызывается после добавления всех узлов). Если узлы и так лежат по строкам,
+    // таблица не нужна.
+    void index_nodes(NodeOrder order);
+
     // Проверяет возможность размещения фигуры
     std::vector<int> get_embedding(std::shared_ptr<Figure> figure, int anchor_id, int rotation) const;
+
+    // Подсетка из заданных клеток: узел i подсетки соответствует cells[i], порты сохраняются,
+    // связи ведут только внутрь набора. Координаты клеток остаются глобальными,
+    // поэтому get_node_id_at для подсетки не применим.
+    std::shared_ptr<Grid> extract_subgrid(const std::vector<int>& cells) const;
 };
 
 // Набор фигур (Bundle)
@@ -96,29 +140,35 @@ public:
     void set_color(const Color& c) { color = c; }
 };
 
-// Класс Задача - объединяет поле и фигуры
+// Класс Задача - объединяет поле, фигуры и решение (размещение бандлов на поле).
+// Сетка и бандлы неизменяемы и разделяются между копиями задачи.
 class Puzzle {
 private:
-    std::shared_ptr<Grid> grid;
+    std::shared_ptr<const Grid> grid;
     std::shared_ptr<std::vector<Bundle>> bundles;
     std::string name;
+    Assignment assignment;
 
 public:
     Puzzle() = default;
 
-    Puzzle(std::shared_ptr<Grid> g, std::shared_ptr<std::vector<Bundle>> b, std::string n = "Untitled")
-        : grid(g), bundles(b), name(n) {}
+    Puzzle(std::shared_ptr<const Grid> g, std::shared_ptr<std::vector<Bundle>> b, std::string n = "Untitled")
+        : grid(g), bundles(b), name(n), assignment(g ? g->size() : 0) {}
 
-    Puzzle(std::shared_ptr<Grid> g, const std::vector<Bundle>& b, std::string n = "Untitled")
-        : grid(g), bundles(std::make_shared<std::vector<Bundle>>(b)), name(n) {}
+    Puzzle(std::shared_ptr<const Grid> g, const std::vector<Bundle>& b, std::string n = "Untitled")
+        : grid(g), bundles(std::make_shared<std::vector<Bundle>>(b)), name(n), assignment(g ? g->size() : 0) {}
 
-    // глубокое копирование для солверов
+    // Копия задачи: сетка и бандлы общие, копируется только решение
     Puzzle clone() const;
     
     // Очистить сетку (стереть ответ)
     void clear_grid();
 
-    std::shared_ptr<Grid> get_grid() const { return grid; }
+    std::shared_ptr<const Grid> get_grid() const { return grid; }
+
+    const Assignment& get_assignment() const { return assignment; }
+    Assignment& get_assignment() { return assignment; }
+    void set_assignment(Assignment a) { assignment = std::move(a); }
     
     // Возвращаем ссылку на вектор внутри shared_ptr
     // const Puzzle дает const vector, но так как это shared_ptr, мы можем дать и не конст, если захотим.
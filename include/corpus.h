@@ -0,0 +1,26 @@
+#pragma once
+#include <string>
+
+// Настройки пакетной генерации (--mode corpus)
+struct CorpusOptions {
+    std::string sweep_path;  // JSON с перебираемыми параметрами
+    std::string output_dir;  // Каталог экземпляров и manifest.json
+    int threads = 1;         // Сколько экземпляров генерируется одновременно
+};
+
+// Генерирует корпус задач по перебору параметров.
+//
+// Файл перебора: каждый ключ - список значений, экземпляры строятся для всех сочетаний:
+//   "sizes": [[ширина, высота], ...]    (по умолчанию [[20, 20]])
+//   "grid_types": [0, 1, 2]             (SQUARE, HEXAGON, TRIANGLE; по умолчанию [0])
+//   "shape_sizes": [[мин, макс], ...]   (по умолчанию [[3, 5]])
+//   "bundle_areas": [[мин, макс], ...]  (по умолчанию [[15, 25]])
+//   "seeds": [первое, последнее]        (включительно; по умолчанию [1, 1])
+//   "tile_size": n, "node_order": n     (необязательно, см. GeneratorConfig)
+//
+// Для каждого экземпляра пишутся задача и эталонное решение (_target) в компактном
+// формате (Serializer::save_compact) и строка manifest.json: файлы, зерно, параметры
+// и оптимальная оценка (эталон покрывает сетку целиком - это площадь всех бандлов).
+// Экземпляры генерируются параллельно, каждый - в одном потоке; результат зависит
+// только от файла перебора.
+int run_corpus(const CorpusOptions& options);
@@ -4,7 +4,7 @@
 #include <memory>
 #include <map>
 #include <random>
-#include <optional>
+#include <cstdint>
 
 // Конфигурация генератора задач
 struct GeneratorConfig {
@@ -15,6 +15,10 @@ struct GeneratorConfig {
     int min_bundle_area = 15;              // Мин. общая площадь набора фигур (бандла)
     int max_bundle_area = 25;              // Макс. общая площадь набора фигур
     GridType grid_type = GridType::SQUARE;
+    NodeOrder node_order = NodeOrder::ROW_MAJOR; // Нумерация клеток (0 - по строкам, 1 - Z-order, 2 - Гильберт)
+    uint64_t seed = 0;                     // Зерно генерации; 0 - случайное
+    int threads = 1;                       // Потоков: тайлы обрабатываются параллельно
+    int tile_size = 256;                   // Сторона тайла генерации (в клетках); 0 - без тайлов, вся сетка одна
 };
 
 class PuzzleGenerator {
@@ -23,34 +27,94 @@ public:
 
     Puzzle generate();
 
+    // Пустая сетка нужного типа в той нумерации клеток и портов, что у сгенерированных задач
+    static std::shared_ptr<Grid> create_grid(GridType type, int width, int height,
+                                             NodeOrder order = NodeOrder::ROW_MAJOR);
+
 private:
     GeneratorConfig config;
     int piece_counter = 0; 
+    uint64_t seed;
     std::mt19937 rng;
+    std::vector<int> local_id;          // клетка сетки -> номер узла в своей фигуре
 
 
     // Методы создания разных типов сеток 
-    std::shared_ptr<Grid> create_square_grid();
-    std::shared_ptr<Grid> create_hex_grid();
-    std::shared_ptr<Grid> create_triangle_grid();
+    // Связи между узлами по координатам; id[y * width + x] - номер клетки (x, y)
+    static void connect_square_grid(Grid& g, const std::vector<int>& id);
+    static void connect_hex_grid(Grid& g, const std::vector<int>& id);
+    static void connect_triangle_grid(Grid& g, const std::vector<int>& id);
+
+    // Разбиение сетки на фигуры без отдельных векторов клеток: метка фигуры у каждой клетки
+    // и односвязный список клеток каждой фигуры. Слияние фигур - union-find по номерам
+    // фигур со сцеплением списков за O(1); метки клеток приводятся к корням один раз в конце.
+    // Номер фигуры - ее начальная клетка (она же голова списка), поэтому номера не нужно
+    // согласовывать между потоками, а массивы индексируются клетками.
+    struct Partition {
+        std::vector<int> label;      // клетка -> фигура, -1 - клетка свободна
+        std::vector<int> next_cell;  // следующая клетка той же фигуры, -1 - конец списка
+        std::vector<int> tail;       // последняя клетка фигуры
+        std::vector<int> area;
+        std::vector<int> parent;     // фигура, в которую слита; parent[s] == s - корень, -1 - не фигура
 
-    // Превращает набор клеток  в отдельный объект Figure
-    std::shared_ptr<Figure> subset_to_figure(std::string name, const std::vector<int>& node_ids, std::shared_ptr<Grid> grid);
+        int find(int s) {
+            while (parent[s] != s) {
+                parent[s] = parent[parent[s]];
+                s = parent[s];
+            }
+            return s;
+        }
 
-    // Внутренняя структура для промежуточного хранения фигур
+        // Корень from сливается в корень into, клетки from дописываются в конец списка into
+        void unite(int from, int into) {
+            parent[from] = into;
+            next_cell[tail[into]] = from;
+            tail[into] = tail[from];
+            area[into] += area[from];
+            area[from] = 0;
+        }
+    };
+
+    // Готовая фигура: граф и ее номер (figure_id клеток в решении)
     struct TempShape {
         std::shared_ptr<Figure> graph;
-        std::vector<int> cells;
+        int id;
         int area;
     };
     
-    //Выращивание одного региона (Random Walk / BFS), true - если вышло
-    std::optional<std::vector<int>> grow_region(int start_node, int target_size, 
-        std::shared_ptr<Grid> grid, 
-        std::vector<char>& is_free);
+    // Прямоугольник сетки, в котором растут и сливаются фигуры (тайл или вся сетка),
+    // со своим потоком случайных чисел и буферами
+    struct GrowArea {
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0; // [x0, x1) x [y0, y1)
+        std::mt19937 rng;
+        std::vector<int> growth;            // клетки растущей фигуры, из которых еще можно расти
+        std::vector<int> neighbors;         // свободные соседи клетки, из которой растем
+        std::vector<int> neighbor_roots;    // соседние фигуры при слиянии
+
+        bool contains(const GridCellData& cell) const {
+            return cell.x >= x0 && cell.x < x1 && cell.y >= y0 && cell.y < y1;
+        }
+    };
+
+    // Разбивает клетки area на фигуры: случайные начальные клетки, выращивание, слияние мелких.
+    // Разные area не пересекаются и могут обрабатываться параллельно
+    void partition_area(const Grid& grid, Partition& part, GrowArea& area);
+
+    //Выращивание одного региона (Random Walk / BFS) новой фигурой в part, true - если вышло
+    bool grow_region(int start_node, int target_size, const Grid& grid, Partition& part, GrowArea& area);
+
+    // Слияние мелких фигур area с соседями из area на месте (union-find в part)
+    void merge_small_shapes(Partition& part, const Grid& grid, GrowArea& area);
+
+    // Швы между тайлами: фигуры, задевающие полосу вдоль каждого шва, снимаются, и их клетки
+    // разбиваются заново уже без границы тайлов. Швы обрабатываются по очереди, у каждого
+    // свой поток случайных чисел из (seed, номер шва)
+    void reconcile_seams(const Grid& grid, Partition& part, int tile, int tiles_x, int tiles_y);
 
-    // Слияние мелких фигур: возвращает новый список фигур
-    std::vector<TempShape> merge_small_shapes(const std::vector<TempShape>& shapes, std::shared_ptr<Grid> grid);
+    // Линейный проход по клеткам: строит графы Figure фигур-корней (топология из сетки)
+    // и записывает figure_id клеток в assignment
+    std::vector<TempShape> extract_figures(Partition& part, const Grid& grid, Assignment& assignment);
 
-    std::vector<Bundle> create_bundles(std::vector<TempShape>& shapes, std::shared_ptr<Grid> grid);
+    // Группирует фигуры в бандлы и записывает bundle_id их клеток в assignment
+    std::vector<Bundle> create_bundles(std::vector<TempShape>& shapes, Assignment& assignment);
 };
@@ -75,6 +75,9 @@ public:
         return id;
     }
 
+    // Резервирует место под count узлов, когда их число известно заранее
+    void reserve(size_t count) { nodes.reserve(count); }
+
     // Добавление направленного ребра от u к v через порт port_u
     void add_directed_edge(int u_id, int v_id, size_t port_u) {
         if (u_id >= 0 && static_cast<size_t>(u_id) < nodes.size()) {
@@ -0,0 +1,150 @@
+#pragma once
+#include "core.hpp"
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Хеш топологии сетки: размеры, тип, координаты и порты всех клеток.
+// Две сетки с равным хешем взаимозаменяемы для солверов.
+uint64_t grid_topology_hash(const Grid& grid);
+
+// Канонический ключ фигуры: BFS-код от якоря (узла 0) по портам, минимальный по всем
+// сдвигам нумерации портов. Не зависит от нумерации остальных узлов: равные ключи -
+// одна и та же фигура с точностью до поворота. shift - сдвиг, на котором достигнут минимум.
+struct FigureKey {
+    uint64_t hash = 0;
+    int shift = 0;
+};
+FigureKey canonical_figure_key(const Figure& figure, size_t grid_ports);
+
+// Ореол следа: клетки вне следа, смежные с ним, без повторов. Элемент ореола -
+// клетка * HALO_MULT + число портов следа, ведущих в нее (кратность касания).
+// out вмещает k * ports элементов; возвращает длину ореола.
+constexpr int HALO_MULT = 8;
+size_t footprint_halo(const Grid& grid, const int* fp, size_t k, int* out);
+
+// Таблица размещений канонической фигуры на сетке: следы для всех пар (якорь, поворот),
+// посчитанные заранее. Следы лежат подряд в одном массиве, недопустимое размещение
+// помечено -1 в первой клетке. Повороты нумеруются от канонического (shift фигуры),
+// поэтому одна таблица подходит всем фигурам с тем же ключом.
+// По запросу таблица хранит и ореолы следов (halo_stride элементов на размещение,
+// хвост дополнен -1) - для оценок, которым нужны свободные клетки вокруг фигуры.
+// Массив либо принадлежит таблице, либо отображен из файла кэша (mmap): сначала следы
+// (count элементов), за ними ореолы.
+// Память: клетки * повороты * (размер фигуры + halo_stride).
+class PlacementTable {
+private:
+    size_t figure_size = 0;
+    size_t rotations = 0;
+    size_t count = 0;                  // число элементов массива следов
+    size_t halo_stride = 0;            // 0 - таблица без ореолов
+    std::shared_ptr<const void> owner; // владелец памяти массива (вектор или отображение файла)
+    const int* cells = nullptr;
+    const int* halos = nullptr;
+
+public:
+    PlacementTable(const Grid& grid, const std::shared_ptr<Figure>& figure, const FigureKey& key, bool with_halos = false);
+    // Таблица над готовым массивом (owner держит память)
+    PlacementTable(size_t figure_size, size_t rotations, size_t count, size_t halo_stride,
+                   std::shared_ptr<const void> owner, const int* cells)
+        : figure_size(figure_size), rotations(rotations), count(count), halo_stride(halo_stride),
+          owner(std::move(owner)), cells(cells), halos(halo_stride ? cells + count : nullptr) {}
+
+    size_t get_figure_size() const { return figure_size; }
+    size_t get_rotations() const { return rotations; }
+    size_t get_halo_stride() const { return halo_stride; }
+    bool has_halos() const { return halos != nullptr; }
+    size_t size() const { return count; }
+    const int* data() const { return cells; }
+    // Следы и ореолы вместе
+    size_t bytes() const { return (count + count / std::max<size_t>(figure_size, 1) * halo_stride) * sizeof(int); }
+
+    // След (figure_size клеток) или nullptr, если фигура в этом положении не помещается
+    const int* footprint(int anchor, int canonical_rotation) const {
+        const int* fp = &cells[((size_t)anchor * rotations + canonical_rotation) * figure_size];
+        return fp[0] == -1 ? nullptr : fp;
+    }
+    // Ореол допустимого размещения (halo_stride элементов, до первого -1); только при has_halos()
+    const int* halo(int anchor, int canonical_rotation) const {
+        return &halos[((size_t)anchor * rotations + canonical_rotation) * halo_stride];
+    }
+};
+
+// Таблица для конкретной фигуры: поворот фигуры переводится в канонический
+struct PlacementView {
+    std::shared_ptr<const PlacementTable> table;
+    int shift = 0;
+
+    explicit operator bool() const { return (bool)table; }
+
+    int canonical(int rotation) const {
+        int r = (int)table->get_rotations();
+        return ((rotation - shift) % r + r) % r;
+    }
+    const int* footprint(int anchor, int rotation) const { return table->footprint(anchor, canonical(rotation)); }
+    const int* halo(int anchor, int rotation) const { return table->halo(anchor, canonical(rotation)); }
+};
+
+// Кэш таблиц размещений по (хеш сетки, ключ фигуры), общий для солверов и потоков.
+// Размер ограничен budget_bytes: при переполнении вытесняются давно не использованные
+// таблицы, которые не держит ни один солвер. Если места так и не нашлось, таблица
+// не строится (солвер обходится без нее).
+//
+// Если задан каталог directory, таблицы хранятся и на диске: файл на каждую пару ключей
+// (заголовок + массив следов), который при следующем запуске отображается в память
+// без разбора. Файлы другой версии формата (PLACEMENT_FORMAT_VERSION) или с несовпавшим
+// заголовком игнорируются и перезаписываются.
+// Таблицы с ореолами и без - разные записи кэша (и разные файлы).
+class PlacementCache {
+public:
+    static constexpr uint32_t PLACEMENT_FORMAT_VERSION = 2;
+
+    // Каталог создается при необходимости
+    explicit PlacementCache(size_t budget_bytes = (size_t)256 << 20, std::string directory = "");
+
+    // Пусто, если таблица не помещается в бюджет
+    PlacementView get(const Grid& grid, uint64_t grid_hash, const std::shared_ptr<Figure>& figure,
+                      bool with_halos = false);
+
+    size_t size() const;
+    size_t bytes() const;
+    size_t hits() const;
+    size_t misses() const;
+    size_t disk_hits() const;
+
+private:
+    struct Key {
+        uint64_t grid, figure;
+        bool halos;
+        bool operator==(const Key& o) const { return grid == o.grid && figure == o.figure && halos == o.halos; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            return (size_t)(k.grid ^ (k.figure * 0x9E3779B97F4A7C15ull) ^ (uint64_t)k.halos);
+        }
+    };
+    struct Item {
+        std::shared_ptr<const PlacementTable> table;
+        std::list<Key>::iterator recent; // позиция в очереди использования
+    };
+
+    bool make_room(size_t bytes); // под mutex
+
+    std::string file_path(const Key& key) const;
+    // nullptr, если файла нет или он не подходит
+    std::shared_ptr<const PlacementTable> load_file(const Key& key, size_t figure_size, size_t rotations,
+                                                    size_t cells) const;
+    void store_file(const Key& key, const PlacementTable& table) const;
+
+    size_t budget;
+    std::string directory;
+    size_t used = 0;
+    size_t hit_count = 0, miss_count = 0, disk_hit_count = 0;
+    mutable std::mutex mutex;
+    std::unordered_map<Key, Item, KeyHash> items;
+    std::list<Key> recent; // от недавно использованных к давним
+};
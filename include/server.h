@@ -0,0 +1,32 @@
+#pragma once
+#include "solvers.h"
+#include <string>
+
+// Настройки демона (--mode serve)
+struct ServerOptions {
+    std::string socket_path;       // Unix-сокет; пусто - запросы из stdin, ответы в stdout
+    int max_concurrent = 1;        // Сколько запросов решается одновременно
+    double max_time_seconds = 60.0; // Предел времени одного запроса
+    size_t cache_mb = 256;         // Бюджет кэша таблиц размещений
+    std::string cache_dir;         // Каталог таблиц размещений на диске; пусто - только память
+    size_t max_grids = 64;         // Сколько сеток держать в кэше
+    SolverConfig defaults;         // Настройки солвера, которые запрос может переопределить;
+                                   // num_threads - и предел потоков одного запроса
+};
+
+// Демон решения задач. Протокол - JSON по строке на запрос и ответ.
+//
+// Запрос: {"id": ..., "algo": "grasp", "time": сек., "threads": n (не больше --threads), "output": путь}
+// и задача одним из способов:
+//   "input": путь к файлу задачи;
+//   "puzzle": задача в формате файла;
+//   "grid_hash": хеш уже загруженной сетки + "bundles" в формате файла - сетка не передается
+//   и не разбирается заново.
+// Ответ: {"id", "ok", "score", "cells", "placed", "grid_hash", "time_ms"} и решение
+// ("assignment": {"bundle_id": [...], "figure_id": [...]}) или, если задан output, файл решения.
+// При ошибке - {"id", "ok": false, "error"}. Служебные запросы: {"cmd": "stats"} - состояние
+// кэшей, {"cmd": "shutdown"} - завершение после текущих запросов.
+//
+// Между запросами хранятся разобранные сетки (по хешу топологии), задачи из файлов
+// (по хешу содержимого) и таблицы размещений фигур (PlacementCache).
+int run_server(const ServerOptions& options);
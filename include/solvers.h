@@ -1,36 +1,193 @@
 #pragma once
 #include "core.hpp"
+#include "placement.hpp"
+#include "utils/TranspositionTable.hpp"
+#include "utils/WorkStealingPool.hpp"
+#include "utils/CowBitset.hpp"
 #include <vector>
 #include <memory>
 #include <random> 
+#include <atomic>
+#include <functional>
+#include <chrono>
+#include <map>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+
+// Стратегия ветвления при поиске места для очередной фигуры
+enum class BranchingStrategy {
+    CONTACT,              // все допустимые места, ранжированные по числу соседей
+    MOST_CONSTRAINED_CELL // только места, накрывающие свободную клетку с минимумом вариантов (как колонка в DLX)
+};
+
+// Какие клетки перебираются как якоря кандидатов
+enum class CandidateEnumeration {
+    FULL,     // все свободные клетки поля, O(площадь) на шаг
+    FRONTIER  // только фронт: свободные клетки у занятых или у границы поля, O(периметр)
+};
+
+// Эвристика оценки допустимого места фигуры (см. utils/ScoringPolicies.hpp)
+enum class ScoringPolicy {
+    CONTACT,   // касания занятых клеток
+    PERIMETER, // касания минус новые свободные клетки у фигуры (короче фронт)
+    BORDER,    // касания, касание края поля вдвое ценнее
+    HOLES,     // касания минус штраф за замурованные свободные клетки
+    EDGES      // касания занятых клеток и края поля поровну (в подзадаче край - стенки региона)
+};
 
 struct SolverConfig {
     int max_iterations = 50;
-    float alpha = 0.8f;
+    float alpha = 0.8f;            // Жадность RCL (если reactive выключен)
+    // Реактивный GRASP: alpha выбирается из набора с вероятностями по качеству прошлых
+    // построений, а бандлы, которые чаще не удается разместить, ставятся раньше.
+    // По умолчанию выключен, чтобы заданный alpha не игнорировался; CLI включает его сам
+    bool reactive = false;
+    // Пул элитных решений и path relinking: каждое законченное построение связывается
+    // путем с одним из элитных решений, лучшая промежуточная точка пути идет в кандидаты
+    int elite_size = 5;            // Размер пула (0 - отключить)
+    int relink_steps = 32;         // Наибольшее число шагов одного пути
+    // Предвыбор подмножеств бандлов (если их площадь больше поля): задача о сумме подмножеств
+    // дает подмножества с лучшими достижимыми суммами, построения по очереди ставят их бандлы первыми
+    int knapsack_targets = 4;      // Сколько целевых подмножеств (0 - отключить)
     bool verbose = false;
     double max_time_seconds = 0.0;
+    int num_threads = 1;           // Сколько потоков параллельно выполняют итерации GRASP
+    int tt_size_log2 = 20;         // log2 размера таблицы транспозиций (0 - отключить)
+    BranchingStrategy branching = BranchingStrategy::CONTACT;
+    CandidateEnumeration enumeration = CandidateEnumeration::FULL;
+    ScoringPolicy scoring = ScoringPolicy::CONTACT;
+    // Параллельный перебор ветвей RCL верхнего уровня для бандлов из многих фигур.
+    // Работает на том же пуле из num_threads потоков, что и итерации.
+    bool parallel_backtracking = false;
+    int parallel_min_shapes = 4;   // Минимум фигур в бандле для распараллеливания
+    // Пространственная декомпозиция (TiledSolver)
+    int tile_size = 32;            // Сторона тайла в клетках
+    int seam_width = 2;            // Полуширина полосы вдоль шва, которую заполняет досборка
+    // Многоуровневая схема (MultilevelSolver)
+    int coarse_bundles = 16;       // Сколько бандлов в среднем помещается в суперклетку уровня распределения
+    int coarse_levels_up = 2;      // На сколько уровней выше распределения поднимаются неразмещенные бандлы
+    // Поиск в больших окрестностях (LNSSolver)
+    int lns_radius = 4;            // Наибольший радиус окна разрушения (в шагах по соседям)
+    int lns_repair_iterations = 20; // Итераций GRASP на восстановление одного окна
+    // Лучевой поиск (BeamSolver)
+    int beam_width = 8;            // Сколько частичных решений хранится после каждого бандла
+    int beam_branching = 4;        // Сколько вариантов размещения бандла порождает одна запись луча
+};
+
+// Лучший найденный счет (incumbent), общий для всех потоков солвера.
+// Используется для отсечения построений, которые уже не могут его превзойти.
+struct SharedIncumbent {
+    std::atomic<float> score{-1.0f};
+
+    float get() const { return score.load(std::memory_order_relaxed); }
+
+    // Обновляет рекорд, если value лучше. Возвращает true, если рекорд обновлен.
+    bool offer(float value) {
+        float current = score.load(std::memory_order_relaxed);
+        while (value > current) {
+            if (score.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
 };
 
 struct SolverResult {
     float score;
     std::vector<int> placed_bundles;
+    Assignment assignment; // bundle_id/figure_id каждой клетки
 };
 
-class GRASPSolver {
+// Общий интерфейс солверов.
+// Солвер только читает сетку graph, а решение возвращает в SolverResult::assignment,
+// поэтому одну загруженную задачу могут одновременно решать несколько солверов.
+// Снаружи можно подключить общий incumbent - тогда солвер отбрасывает построения, которые
+// не могут его превзойти, и флаг остановки, по которому солвер завершается досрочно
+// с лучшим найденным решением. Прежнее решение (warm start) используют солверы, которые
+// умеют улучшать готовое решение (lns); остальные решают с нуля.
+class Solver {
 public:
-    std::shared_ptr<Grid> graph;
+    std::shared_ptr<const Grid> graph;
     std::vector<Bundle> bundles;
     std::vector<int> placed_bundles;
     SolverConfig config;
-    
+
+    Solver(const Puzzle& p, SolverConfig cfg)
+        : graph(p.get_grid()), bundles(p.get_bundles()), config(cfg),
+          incumbent(std::make_shared<SharedIncumbent>()) {}
+    virtual ~Solver() = default;
+
+    virtual SolverResult solve() = 0;
+    // Использует ли solve() прежнее решение из set_warm_start (остальные солверы его не читают)
+    virtual bool supports_warm_start() const { return false; }
+
+    void share_incumbent(std::shared_ptr<SharedIncumbent> shared) { incumbent = std::move(shared); }
+    void set_stop_flag(const std::atomic<bool>* flag) { stop = flag; }
+    // prior - задача с прежним решением
+    void set_warm_start(std::shared_ptr<const Puzzle> prior) { warm_start = std::move(prior); }
+    // Общий кэш таблиц размещений: солверы, которые перебирают места фигур (grasp),
+    // берут следы из таблиц вместо вложения фигуры на каждом шаге
+    void set_placement_cache(std::shared_ptr<PlacementCache> cache) { placement_cache = std::move(cache); }
+
+protected:
+    std::shared_ptr<SharedIncumbent> incumbent;
+    const std::atomic<bool>* stop = nullptr;
+    std::shared_ptr<const Puzzle> warm_start;
+    std::shared_ptr<PlacementCache> placement_cache;
+
+    bool stop_requested() const { return stop && stop->load(std::memory_order_relaxed); }
+};
+
+// Реестр солверов: имя алгоритма (--algo) -> фабрика
+class SolverRegistry {
+public:
+    using Factory = std::function<std::unique_ptr<Solver>(const Puzzle&, const SolverConfig&)>;
+
+    static SolverRegistry& instance();
+
+    void add(const std::string& name, Factory factory);
+    // nullptr, если алгоритм с таким именем не зарегистрирован
+    std::unique_ptr<Solver> create(const std::string& name, const Puzzle& p, const SolverConfig& cfg) const;
+    std::vector<std::string> names() const;
+
+private:
+    std::map<std::string, Factory> factories;
+};
+
+class GRASPSolver : public Solver {
+public:
     GRASPSolver(const Puzzle& p, SolverConfig cfg = SolverConfig()) 
-        : graph(p.get_grid()), bundles(p.get_bundles()), config(cfg) {}
+        : Solver(p, cfg),
+          zobrist(p.get_grid()->size()), failed_states(cfg.tt_size_log2) {
+        init_boundary_cells();
+        for(size_t i = 0; i < bundles.size(); ++i) {
+            bundle_index[bundles[i].get_id()] = (int)i;
+        }
+    }
         
-    SolverResult solve();
+    SolverResult solve() override;
     
 private:
+    friend struct SolverChecks; // проверки инвариантов доски (src/checks_main.cpp)
+
+    ZobristKeys zobrist;
+    std::vector<int> boundary_cells; // клетки, у которых есть порт за пределы поля
+    std::vector<uint8_t> boundary_ports; // число портов каждой клетки за пределы поля
+    WorkStealingPool* pool = nullptr; // пул потоков на время solve() (если num_threads > 1)
+    bool use_deadline = false;        // время solve() ограничено: построение прерывается по deadline
+    std::chrono::high_resolution_clock::time_point deadline;
+    // Запоминает состояния "бандл X с фигурами i.. не достраивается с этой занятости"
+    // (только доказанные полным перебором, см. SearchContext::exhausted)
+    TranspositionTable failed_states;
+    // Таблицы размещений фигур из placement_cache на время solve()
+    std::unordered_map<const Figure*, PlacementView> placements;
+
     struct SolutionState {
         float score;
+        bool aborted = false;  // построение прервано: оценка сверху не превышает incumbent или вышло время
+        float alpha = 0.0f;    // жадность RCL, с которой построено решение (ее же берет path relinking)
         std::vector<int> node_allocations;
         std::vector<int> node_figure_ids;
         std::vector<int> placed_bundle_ids;
@@ -44,15 +201,312 @@ private:
         int score;                      
     };
 
-    SolutionState run_construction_phase();
+    // Занятость поля во время построения и ее Zobrist-хеш.
+    // contacts - для каждой клетки число портов, ведущих в занятую клетку или за край поля;
+    // обновляется при установке и снятии фигур, по нему оценка места не обходит соседей.
+    // frontier - фронт (в режиме FRONTIER): ровно свободные клетки с contacts > 0, то есть
+    // у занятых клеток или у края поля. Множество с индексом frontier_pos (-1 - не во фронте):
+    // occupy и release добавляют и убирают клетки за O(1), так что размер фронта - периметр
+    // свободной области, а не занятая площадь. visit/visit_epoch - пометки обхода полосы
+    // у фронта (collect_candidates_impl), чтобы не очищать массив на каждом переборе.
+    struct BoardState {
+        std::vector<char> occupied;
+        std::vector<uint8_t> contacts;
+        uint64_t hash = 0;
+        std::vector<int> frontier;
+        std::vector<int> frontier_pos;
+        mutable std::vector<uint32_t> visit;
+        mutable uint32_t visit_epoch = 0;
+    };
+
+    // Контекст одного поиска: генератор случайных чисел, жадность RCL этого построения
+    // и флаг отмены, который выставляется, когда соседняя параллельная ветка уже нашла решение.
+    // exhausted - последний неудачный вызов place_shapes_recursive перебрал все допустимые
+    // места (RCL не усекал их, фронт не сужал): такой провал верен для любого построения
+    // и записывается в failed_states, эвристический - нет
+    struct SearchContext {
+        std::mt19937& rng;
+        float alpha;
+        const std::atomic<bool>* cancel = nullptr;
+        bool exhausted = false;
+
+        bool cancelled() const { return cancel && cancel->load(std::memory_order_relaxed); }
+    };
+
+    SolutionState run_construction_phase(std::mt19937& rng);
+
+    // Статистика обучения за время solve() (общая для потоков, под мьютексом)
+    struct LearningState {
+        std::mutex mutex;
+        std::vector<float> alphas = {0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f};
+        std::vector<double> score_sum;   // сумма счетов построений с каждым alpha
+        std::vector<int> uses;
+        std::vector<double> probability;
+        double best_score = 0.0;
+        int since_update = 0;
+        std::vector<int> failures;       // сколько раз бандл (по индексу) не удалось разместить
+        int constructions = 0;
+    };
+    LearningState learning;
+
+    // Пул элитных решений: лучшие из найденных и попарно непохожие
+    std::vector<SolutionState> elite;
+    std::mutex elite_mutex;
+    std::unordered_map<int, int> bundle_index; // id бандла -> индекс в bundles
+
+    // Целевые подмножества бандлов (маски по индексам) и оценка сверху на занятую площадь:
+    // наибольшая сумма площадей бандлов, не превышающая числа клеток
+    std::vector<std::vector<char>> targets;
+    std::atomic<size_t> next_target{0};
+    size_t area_bound = 0;
+
+    void init_targets();
+
+    void offer_elite(const SolutionState& state);
+    SolutionState path_relink(const SolutionState& from, const SolutionState& to, std::mt19937& rng);
+
+    void init_learning();
+    int choose_alpha(std::mt19937& rng);
+    std::vector<int> construction_order();
+    // complete - построение дошло до конца (не прервано оценкой сверху или временем)
+    void record_construction(int alpha_idx, float score, const std::vector<int>& failed_bundles, bool complete);
     
-    int calculate_placement_score(const std::vector<int>& footprint, const std::vector<char>& occupied_mask);
+    void init_boundary_cells();
+    BoardState make_empty_board() const;
+
+    // Возвращают количество найденных допустимых мест. Каждое место передается получателю
+    // sink(int anchor, int rotation, std::vector<int>& footprint, int score); его тип - параметр
+    // шаблона, поэтому вызов встраивается в перебор, как и оценка места.
+    // collect_candidates выбирает по config.scoring и типу сетки готовую конкретизацию
+    // collect_candidates_impl, в которой оценка места и обход портов подставлены на этапе компиляции
+    // anchors - перебирать только эти якоря (nullptr - все, с учетом FRONTIER)
+    template <class Sink>
+    int collect_candidates(const std::shared_ptr<Figure>& shape, const BoardState& board,
+                           Sink&& sink, const std::vector<int>* anchors = nullptr);
+    template <class Policy, int Ports, class Sink>
+    int collect_candidates_impl(const std::shared_ptr<Figure>& shape, const BoardState& board,
+                                Sink& sink, const std::vector<int>* anchors);
+    // fp и halo - буферы для следа и его ореола, общие для вызовов из одного перебора
+    template <class Policy, int Ports, class Sink>
+    int collect_candidates_at(int anchor, const std::shared_ptr<Figure>& shape, const PlacementView& view,
+                              const BoardState& board, std::vector<int>& fp, std::vector<int>& halo,
+                              Sink& sink);
+    // Места фигуры, накрывающие самую зажатую свободную клетку (BranchingStrategy::MOST_CONSTRAINED_CELL)
+    void collect_constrained_candidates(const std::shared_ptr<Figure>& shape, const BoardState& board,
+                                        std::mt19937& rng, std::vector<SinglePlacement>& out);
+    // Места фигуры, накрывающие клетку cell
+    void collect_covering(const std::shared_ptr<Figure>& shape, const BoardState& board, int cell,
+                          std::vector<SinglePlacement>& out);
+    void keep_most_constrained_cell(std::vector<SinglePlacement>& candidates, std::mt19937& rng) const;
+
+    // Установка и снятие фигуры: занятость, хеш, счетчики касаний и фронт
+    void occupy(BoardState& board, const std::vector<int>& footprint) const;
+    void release(BoardState& board, const std::vector<int>& footprint) const;
+    static void frontier_add(BoardState& board, int nid);
+    static void frontier_remove(BoardState& board, int nid);
     
     bool place_shapes_recursive(
         int shape_idx, 
-        const std::vector<std::shared_ptr<Figure>>& shapes, 
-        std::vector<char>& current_occupied_mask, 
+        const Bundle& bundle, 
+        BoardState& board, 
         std::vector<SinglePlacement>& out_placements,
-        std::mt19937& rng
+        SearchContext& ctx
     );
+
+    // Перебор ветвей rcl первой фигуры бандла задачами пула, каждая на своей копии поля
+    bool place_shapes_parallel(
+        const Bundle& bundle,
+        BoardState& board,
+        const std::vector<SinglePlacement>& rcl,
+        std::vector<SinglePlacement>& out_placements,
+        SearchContext& ctx
+    );
+};
+
+// Решение подзадачи на части поля. Индексы в cell_bundle/cell_figure - локальные
+// номера клеток региона (позиции в переданном списке cells).
+struct RegionSolution {
+    float score = 0.0f;
+    std::vector<int> placed;       // id размещенных бандлов
+    std::vector<int> cell_bundle;  // bundle_id клетки региона или -1
+    std::vector<int> cell_figure;  // локальный figure_id клетки региона или -1
+};
+
+// Конфиг подзадачи: один поток (параллельность - на уровне регионов), небольшая
+// таблица транспозиций и time_budget секунд, если время основного солвера ограничено
+SolverConfig make_region_config(const SolverConfig& base, double time_budget);
+
+// Решает подзадачу GRASP на подсетке из cells с заданными бандлами.
+// Если задан must_beat, возвращаются только решения со счетом больше него (иначе счет -1).
+RegionSolution solve_region(const Grid& grid, const std::vector<int>& cells,
+                            const std::vector<Bundle>& bundles, const SolverConfig& cfg,
+                            float must_beat = -1.0f);
+
+// Решение всего поля, собираемое из решений регионов
+struct PartialSolution {
+    std::vector<int> cell_bundle;  // bundle_id клетки или -1
+    std::vector<int> cell_figure;  // глобальный figure_id клетки или -1
+    int next_figure_id = 0;
+
+    explicit PartialSolution(size_t cells = 0) : cell_bundle(cells, -1), cell_figure(cells, -1) {}
+
+    // Переносит решение региона, перенумеровывая его фигуры
+    void commit(const std::vector<int>& cells, const RegionSolution& region);
+
+    // Итог солвера; счет - число занятых клеток
+    SolverResult to_result() const;
+};
+
+// Переносит решение задачи prior на сетку grid. Клетки сопоставляются по координатам,
+// поэтому поле могло измениться. Бандл сохраняется, если он есть в bundles и каждая его
+// фигура по-прежнему совпадает с вложением одной из его форм; иначе размещение отбрасывается.
+// В dirty попадают клетки отброшенных размещений и клетки, которых не было в prior.
+PartialSolution load_warm_start(const Grid& grid, const std::vector<Bundle>& bundles,
+                                const Puzzle& prior, std::vector<int>& dirty);
+
+// Пространственная декомпозиция для очень больших полей.
+// Поле режется на тайлы tile_size x tile_size, бандлы распределяются по тайлам
+// по бюджету площади, тайлы решаются GRASP параллельно. Полосы вдоль швов
+// остаются свободными, и на втором этапе в них досборкой размещаются оставшиеся бандлы.
+// Бандлы крупнее любого тайла и отрезка шва в конце ставятся на все свободные клетки поля;
+// остальные не вставшие бандлы остаются неразмещенными. Время работы определяется размером
+// тайла и числом ядер, а не площадью поля - кроме этого последнего прохода, который нужен,
+// только если бандлы крупнее тайлов.
+class TiledSolver : public Solver {
+public:
+    TiledSolver(const Puzzle& p, SolverConfig cfg = SolverConfig())
+        : Solver(p, cfg) {}
+
+    SolverResult solve() override;
+};
+
+// Многоуровневая схема (coarse-to-fine).
+// Поле огрубляется в иерархию графов суперклеток: на каждом уровне клетки объединяются
+// блоками 2x2 по координатам (для всех типов сеток: блок 2x2 гекс- или треугольной сетки
+// тоже связен), суперклетки связываются, если между ними есть ребро исходной сетки.
+// На уровне, где емкость суперклетки порядка нескольких бандлов, бандлы распределяются
+// по суперклеткам, после чего каждая суперклетка решается GRASP на своих клетках.
+// Неразмещенные бандлы поднимаются на уровень выше, где регион - свободные клетки
+// родительской суперклетки, но не больше чем на coarse_levels_up уровней: регион растет
+// самое большее в 4^coarse_levels_up раз, работа линейна по площади поля, а размер
+// подзадач от него не зависит. Бандлы крупнее любой суперклетки последнего уровня
+// в конце ставятся одной подзадачей на все свободные клетки поля.
+class MultilevelSolver : public Solver {
+public:
+    MultilevelSolver(const Puzzle& p, SolverConfig cfg = SolverConfig())
+        : Solver(p, cfg) {}
+
+    SolverResult solve() override;
+
+private:
+    // Данные суперклетки: координаты на своем уровне и число клеток исходного поля
+    struct CoarseCellData {
+        int x = 0, y = 0;
+        int capacity = 0;
+    };
+    using CoarseGraph = Graph<CoarseCellData>;
+
+    struct Level {
+        CoarseGraph graph{MAX_PORTS_CAPACITY};
+        std::vector<int> parent;     // узел предыдущего (более мелкого) уровня -> суперклетка
+        std::vector<int> fine_owner; // клетка поля -> суперклетка этого уровня
+    };
+
+    // Огрубляет граф: узлы с координатами (x/2, y/2) сливаются в один
+    template <typename T>
+    static Level coarsen(const Graph<T>& fine, const std::vector<int>& fine_owner);
+};
+
+// Поиск в больших окрестностях (Large Neighborhood Search).
+// Начальное решение строит GRASP, затем решение многократно улучшается: вокруг случайной
+// свободной клетки выбирается окно (растет, пока в нем не наберется места на самый маленький
+// неразмещенный бандл, но не дальше lns_radius), все бандлы, задевающие окно, снимаются,
+// и окно вместе с их клетками заново заполняется GRASP с возвратами из снятых и еще
+// не размещенных бандлов. Ход принимается, если занятая площадь не уменьшилась.
+// За раунд обрабатывается по окну на поток, окна не пересекаются.
+// С warm start начальным решением служит прежнее (без недопустимых размещений), а окна
+// сначала ставятся на измененные клетки - время досборки зависит от размера изменения.
+class LNSSolver : public Solver {
+public:
+    LNSSolver(const Puzzle& p, SolverConfig cfg = SolverConfig())
+        : Solver(p, cfg) {}
+
+    SolverResult solve() override;
+    bool supports_warm_start() const override { return true; }
+};
+
+// Лучевой поиск (beam search).
+// Бандлы перебираются в том же порядке, что и в GRASP (от крупных к мелким). После каждого
+// бандла хранятся beam_width лучших частичных решений: каждое порождает до beam_branching
+// размещений бандла (лучшие по числу контактов, с возвратами по фигурам) и вариант "пропустить",
+// из всех потомков остаются лучшие по занятой площади, затем по контактам.
+// Записи разделяют неизменяемые маски занятости (CowBitset) и общую историю размещений,
+// копия маски делается только для выживших потомков. Поиск детерминирован, а время
+// работы предсказуемо: O(бандлы * beam_width * beam_branching * фронт).
+class BeamSolver : public Solver {
+public:
+    BeamSolver(const Puzzle& p, SolverConfig cfg = SolverConfig())
+        : Solver(p, cfg), zobrist(p.get_grid()->size()) {}
+
+    SolverResult solve() override;
+
+private:
+    ZobristKeys zobrist;
+
+    // История размещений - неизменяемый список, общий для потомков одной записи
+    struct Trail {
+        std::shared_ptr<const Trail> parent;
+        int bundle_id = -1;
+        std::vector<std::vector<int>> footprints;
+    };
+
+    struct BeamEntry {
+        CowBitset occupied;
+        uint64_t hash = 0;
+        size_t area = 0;
+        long long contact = 0;
+        std::shared_ptr<const Trail> trail;
+    };
+
+    // Размещение бандла целиком: следы фигур и суммарные контакты
+    struct BundlePlacement {
+        std::vector<std::vector<int>> footprints;
+        long long contact = 0;
+    };
+
+    int count_contacts(const std::vector<int>& footprint, const CowBitset& occupied,
+                       const std::vector<char>& local) const;
+    // Перебор размещений фигур бандла с shape_idx. local - клетки, занятые уже
+    // поставленными фигурами этого бандла. Возвращает true, если добавлено хотя бы одно.
+    bool expand(const Bundle& bundle, const BeamEntry& entry, size_t shape_idx,
+                std::vector<char>& local, BundlePlacement& current,
+                std::vector<BundlePlacement>& out, int limit) const;
+};
+
+// Портфель: несколько солверов (разные алгоритмы и настройки) решают одну задачу
+// одновременно, каждый в своем потоке (сетка у всех общая, только для чтения), с общим incumbent.
+// Всего потоков config.num_threads: участников не больше, но не меньше двух (при одном потоке
+// они делят его по времени); лишние потоки отдаются первым из них.
+// Гонка останавливается, как только кто-то достиг оценки сверху (наибольшая сумма площадей
+// бандлов, не превышающая числа клеток) - это доказанный оптимум, - или вышло время.
+class PortfolioSolver : public Solver {
+public:
+    // Участник гонки: алгоритм из реестра и его настройки
+    struct Entry {
+        std::string algo;
+        SolverConfig config;
+    };
+
+    std::vector<Entry> entries; // пусто - набор по умолчанию
+
+    PortfolioSolver(const Puzzle& p, SolverConfig cfg = SolverConfig())
+        : Solver(p, cfg), puzzle(p) {}
+
+    SolverResult solve() override;
+    bool supports_warm_start() const override { return true; }
+
+private:
+    Puzzle puzzle;
+
+    std::vector<Entry> default_entries() const;
 };
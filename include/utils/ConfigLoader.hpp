@@ -37,6 +37,10 @@ public:
             if(j.contains("min_bundle_area")) cfg.min_bundle_area = j["min_bundle_area"];
             if(j.contains("max_bundle_area")) cfg.max_bundle_area = j["max_bundle_area"];
             if(j.contains("grid_type")) cfg.grid_type = (GridType)j["grid_type"];
+            if(j.contains("node_order")) cfg.node_order = (NodeOrder)j["node_order"];
+            if(j.contains("seed")) cfg.seed = j["seed"];
+            if(j.contains("threads")) cfg.threads = j["threads"];
+            if(j.contains("tile_size")) cfg.tile_size = j["tile_size"];
         } catch (const std::exception& e) {
             std::cerr << "Error parsing config: " << e.what() << ". Using defaults for missing fields." << std::endl;
         }
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Битовое множество с копированием при записи (copy-on-write).
+//
+// Копия разделяет слова с оригиналом, пока одна из них не изменится: тогда
+// изменяемая копия получает собственный буфер. Так множество состояний (например,
+// записи луча, пропустившие бандл) хранят одну общую неизменяемую маску занятости.
+// Счетчик ссылок shared_ptr атомарный, но сам буфер не синхронизирован: изменять
+// копии одной маски из разных потоков одновременно нельзя.
+class CowBitset {
+private:
+    std::shared_ptr<std::vector<uint64_t>> words;
+    size_t bits = 0;
+
+    void detach() {
+        if (words.use_count() > 1) {
+            words = std::make_shared<std::vector<uint64_t>>(*words);
+        }
+    }
+
+public:
+    CowBitset() : words(std::make_shared<std::vector<uint64_t>>()) {}
+
+    explicit CowBitset(size_t n)
+        : words(std::make_shared<std::vector<uint64_t>>((n + 63) / 64, 0)), bits(n) {}
+
+    size_t size() const { return bits; }
+
+    bool test(size_t i) const { return ((*words)[i >> 6] >> (i & 63)) & 1ull; }
+
+    void set(size_t i) {
+        detach();
+        (*words)[i >> 6] |= 1ull << (i & 63);
+    }
+
+    void reset(size_t i) {
+        detach();
+        (*words)[i >> 6] &= ~(1ull << (i & 63));
+    }
+
+    // Установить набор битов за одно копирование
+    void set_all(const std::vector<int>& indices) {
+        detach();
+        for (int i : indices) (*words)[(size_t)i >> 6] |= 1ull << ((size_t)i & 63);
+    }
+
+    size_t count() const {
+        size_t total = 0;
+        for (uint64_t w : *words) total += (size_t)__builtin_popcountll(w);
+        return total;
+    }
+
+    // Разделяют ли две маски один буфер
+    bool shares_with(const CowBitset& other) const { return words == other.words; }
+};
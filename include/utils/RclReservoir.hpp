@@ -0,0 +1,99 @@
+#pragma once
+#include <algorithm>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Потоковый RCL (Restricted Candidate List) ограниченного размера.
+//
+// Эквивалент схемы "собрать всех кандидатов -> оставить score >= alpha * max_score ->
+// перемешать -> взять первые k", но без хранения всех кандидатов. Для каждого значения
+// score держим счетчик и равномерную выборку размера k (reservoir sampling, алгоритм R).
+// Корзины ниже текущего порога alpha * max выбрасываются сразу: максимум только растет,
+// поэтому они уже никогда не пройдут в RCL. Память: O(k * число различных score над порогом).
+template <typename T>
+class RclReservoir {
+private:
+    struct Bucket {
+        long long seen = 0;
+        std::vector<T> sample;
+    };
+
+    size_t k;
+    float alpha;
+    bool has_max = false;
+    int max_score = 0;
+    long long total = 0;
+    std::map<int, Bucket> buckets;
+
+    bool passes(int score) const {
+        return max_score <= 0 || score >= max_score * alpha;
+    }
+
+public:
+    RclReservoir(size_t k, float alpha) : k(k), alpha(alpha) {}
+
+    // Сколько кандидатов всего было предложено
+    long long size() const { return total; }
+
+    // Предлагает кандидата со значением score. make_item вызывается только если
+    // кандидат действительно попадает в выборку, так что отсеянные ничего не стоят.
+    template <typename Make, typename Rng>
+    void offer(int score, Make&& make_item, Rng& rng) {
+        total++;
+        if (!has_max || score > max_score) {
+            has_max = true;
+            max_score = score;
+            // Ранняя отсечка: корзины ниже нового порога больше не нужны
+            while (!buckets.empty() && !passes(buckets.begin()->first)) {
+                buckets.erase(buckets.begin());
+            }
+        }
+        if (!passes(score)) return;
+
+        Bucket& b = buckets[score];
+        b.seen++;
+        if (b.sample.size() < k) {
+            b.sample.push_back(make_item());
+        } else {
+            std::uniform_int_distribution<long long> dist(0, b.seen - 1);
+            long long j = dist(rng);
+            if (j < (long long)k) b.sample[j] = make_item();
+        }
+    }
+
+    // Возвращает до k кандидатов в случайном порядке - с тем же распределением,
+    // что и перемешанный полный RCL, усеченный до k.
+    template <typename Rng>
+    std::vector<T> take(Rng& rng) {
+        std::vector<T> result;
+        long long remaining = 0;
+        for (auto& [score, b] : buckets) {
+            std::shuffle(b.sample.begin(), b.sample.end(), rng);
+            remaining += b.seen;
+        }
+
+        // Последовательная выборка без возвращения: корзина выбирается с вероятностью,
+        // пропорциональной числу еще не взятых в ней кандидатов.
+        std::vector<long long> left;
+        std::vector<Bucket*> order;
+        for (auto& [score, b] : buckets) {
+            left.push_back(b.seen);
+            order.push_back(&b);
+        }
+        std::vector<size_t> taken(order.size(), 0);
+        while (result.size() < k && remaining > 0) {
+            long long r = std::uniform_int_distribution<long long>(0, remaining - 1)(rng);
+            size_t bi = 0;
+            while (r >= left[bi]) {
+                r -= left[bi];
+                bi++;
+            }
+            result.push_back(std::move(order[bi]->sample[taken[bi]++]));
+            left[bi]--;
+            remaining--;
+        }
+        return result;
+    }
+};
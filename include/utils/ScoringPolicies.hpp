@@ -0,0 +1,110 @@
+#pragma once
+#include "../placement.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Эвристики оценки размещения фигуры для перебора кандидатов (больше - лучше).
+//
+// Политика - структура со статическим score<Ports>(candidate) и флагом NEEDS_HALO.
+// Число портов - параметр шаблона, поэтому циклы разворачиваются, а перебор, в который
+// политика подставлена (GRASPSolver::collect_candidates_impl), обходится без косвенных
+// вызовов. Касание - порт клетки фигуры, ведущий в занятую клетку; край поля (порт -1,
+// в подзадаче это и клетки вне региона) учитывают только Border и Edges.
+//
+// Соседей следа политики не обходят: касания берутся из счетчиков contacts, которые
+// солвер обновляет при установке и снятии фигур, а свободные клетки вокруг фигуры -
+// из ореола следа (footprint_halo), заранее посчитанного в таблице размещений.
+namespace scoring {
+
+// Допустимое место фигуры на текущем поле
+struct Candidate {
+    const int* fp;                          // след, k клеток
+    size_t k;
+    const int* halo;                        // ореол (до halo_len элементов или первого -1), если NEEDS_HALO
+    size_t halo_len;
+    const std::vector<char>& occupied;      // занятость поля без этой фигуры
+    const std::vector<uint8_t>& contacts;   // сколько портов клетки ведут в занятую клетку или за край
+    const std::vector<uint8_t>& boundary;   // сколько портов клетки ведут за край поля
+};
+
+// Порты следа, упирающиеся в занятую клетку или край поля. Клетки следа свободны,
+// поэтому это сумма счетчиков contacts по следу
+inline int blocked_ports(const Candidate& c) {
+    int sum = 0;
+    for (size_t i = 0; i < c.k; ++i) sum += c.contacts[c.fp[i]];
+    return sum;
+}
+
+// Порты следа, ведущие за край поля
+inline int edge_ports(const Candidate& c) {
+    int sum = 0;
+    for (size_t i = 0; i < c.k; ++i) sum += c.boundary[c.fp[i]];
+    return sum;
+}
+
+// Касания фигуры: порты следа, упирающиеся в занятую клетку
+inline int contact_ports(const Candidate& c) {
+    return blocked_ports(c) - edge_ports(c);
+}
+
+// +10 за каждый порт фигуры, упирающийся в занятую клетку: фигуры прилипают друг к другу
+struct Contact {
+    static constexpr bool NEEDS_HALO = false;
+    template <int Ports>
+    static int score(const Candidate& c) {
+        return 10 * contact_ports(c);
+    }
+};
+
+// Наименьший периметр свободной области: штраф за каждую свободную клетку, которая
+// станет соседней с фигурой (их число - новая длина фронта), плюс касания как в Contact
+struct Perimeter {
+    static constexpr bool NEEDS_HALO = true;
+    template <int Ports>
+    static int score(const Candidate& c) {
+        int free_cells = 0;
+        for (size_t i = 0; i < c.halo_len && c.halo[i] != -1; ++i) {
+            if (!c.occupied[c.halo[i] / HALO_MULT]) free_cells++;
+        }
+        return 10 * (contact_ports(c) - free_cells);
+    }
+};
+
+// Прижимание к краю поля: касание края вдвое ценнее касания занятой клетки.
+// Заполнение идет от стенок внутрь, и в центре остается одна связная область
+struct Border {
+    static constexpr bool NEEDS_HALO = false;
+    template <int Ports>
+    static int score(const Candidate& c) {
+        return 10 * contact_ports(c) + 20 * edge_ports(c);
+    }
+};
+
+// Избегание дыр: касания как в Contact и крупный штраф за каждую соседнюю свободную
+// клетку, которую фигура замуровывает: все ее порты, кроме ведущих в фигуру, уже
+// упираются в занятые клетки или край
+struct Holes {
+    static constexpr bool NEEDS_HALO = true;
+    template <int Ports>
+    static int score(const Candidate& c) {
+        int sealed = 0;
+        for (size_t i = 0; i < c.halo_len && c.halo[i] != -1; ++i) {
+            int n = c.halo[i] / HALO_MULT;
+            if (!c.occupied[n] && c.contacts[n] + c.halo[i] % HALO_MULT == Ports) sealed++;
+        }
+        return 10 * contact_ports(c) - 40 * sealed;
+    }
+};
+
+// +10 за каждый порт, упирающийся в занятую клетку или край поля: фигуры прилипают
+// и к стенкам. В подзадаче (LNS, тайлы) стенки - клетки, занятые вне региона
+struct Edges {
+    static constexpr bool NEEDS_HALO = false;
+    template <int Ports>
+    static int score(const Candidate& c) {
+        return 10 * blocked_ports(c);
+    }
+};
+
+} // namespace scoring
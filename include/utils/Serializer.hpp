@@ -1,8 +1,10 @@
 #pragma once
 #include "../core.hpp"
+#include "../generators.h"
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <vector>
 #include <nlohmann/json.hpp>
 
@@ -29,18 +31,20 @@ public:
         return j_nodes;
     }
 
-    // Сохранение задачи (Puzzle) в JSON файл
-    static void save(const Puzzle& puzzle, const std::string& filename) {
+    // Задача (Puzzle) в JSON
+    static json to_json(const Puzzle& puzzle) {
         json j;
         auto grid = puzzle.get_grid();
         const auto& bundles = puzzle.get_bundles();
+        const Assignment& assignment = puzzle.get_assignment();
         
         // 1. Информация о сетке
         j["grid"] = {
             {"width", grid->get_width()},
             {"height", grid->get_height()},
             {"type", (int)grid->get_type()},
-            {"max_ports", grid->get_max_ports()}
+            {"max_ports", grid->get_max_ports()},
+            {"node_order", (int)grid->get_node_order()}
         };
 
         // 2. Клетки (Узлы) с данными и топологией
@@ -55,8 +59,8 @@ public:
                 {"id", node.get_id()},
                 {"x", node.get_data().x},
                 {"y", node.get_data().y},
-                {"bundle_id", node.get_data().bundle_id}, 
-                {"figure_id", node.get_data().figure_id}, 
+                {"bundle_id", assignment.bundle_id[node.get_id()]}, 
+                {"figure_id", assignment.figure_id[node.get_id()]}, 
                 {"ports", ports}
             });
         }
@@ -84,7 +88,69 @@ public:
             j_bundles.push_back(j_b);
         }
         j["bundles"] = j_bundles;
+        return j;
+    }
+
+    // Компактный формат сгенерированной задачи. Сетка задается только размерами и типом:
+    // клетки и порты восстанавливает PuzzleGenerator::create_grid, поэтому формат годится
+    // лишь для стандартных сеток генератора. Решение - два плоских массива (их нет, если
+    // все клетки свободны), фигура - плоский массив портов узлов (size * max_ports).
+    // Читается тем же load()/from_json().
+    static constexpr int COMPACT_FORMAT_VERSION = 1;
+
+    static json to_compact_json(const Puzzle& puzzle) {
+        json j;
+        auto grid = puzzle.get_grid();
+        const Assignment& assignment = puzzle.get_assignment();
+
+        j["format"] = "compact";
+        j["version"] = COMPACT_FORMAT_VERSION;
+        j["grid"] = {
+            {"width", grid->get_width()},
+            {"height", grid->get_height()},
+            {"type", (int)grid->get_type()},
+            {"max_ports", grid->get_max_ports()},
+            {"node_order", (int)grid->get_node_order()}
+        };
+        bool solved = std::any_of(assignment.bundle_id.begin(), assignment.bundle_id.end(),
+                                  [](int b) { return b != -1; });
+        if (solved) {
+            j["bundle_id"] = assignment.bundle_id;
+            j["figure_id"] = assignment.figure_id;
+        }
+
+        json j_bundles = json::array();
+        for(const auto& b : puzzle.get_bundles()) {
+            json j_shapes = json::array();
+            for(const auto& s : b.get_shapes()) {
+                std::vector<int> ports;
+                ports.reserve(s->size() * s->get_max_ports());
+                for (const auto& node : s->get_nodes()) {
+                    for(size_t p = 0; p < s->get_max_ports(); ++p) ports.push_back(node.get_neighbor(p));
+                }
+                j_shapes.push_back({{"name", s->name}, {"ports", ports}});
+            }
+            j_bundles.push_back({
+                {"id", b.get_id()},
+                {"color", {b.get_color().r, b.get_color().g, b.get_color().b}},
+                {"shapes", j_shapes}
+            });
+        }
+        j["bundles"] = j_bundles;
+        return j;
+    }
+
+    // Сохранение в компактном формате (без отступов и без вывода в консоль)
+    static bool save_compact(const Puzzle& puzzle, const std::string& filename) {
+        std::ofstream out(filename);
+        if (!out.is_open()) return false;
+        out << to_compact_json(puzzle).dump();
+        return (bool)out;
+    }
 
+    // Сохранение задачи (Puzzle) в JSON файл
+    static void save(const Puzzle& puzzle, const std::string& filename) {
+        json j = to_json(puzzle);
         std::ofstream out(filename);
         if (out.is_open()) {
             out << j.dump(4);
@@ -105,86 +171,155 @@ public:
 
         json j;
         in >> j;
+        return from_json(j, filename);
+    }
+
+    // Задача из JSON (формат файла задачи)
+    static Puzzle from_json(const json& j, const std::string& name) {
+        if (j.value("format", "") == "compact") return from_compact_json(j, name);
+        Assignment assignment;
+        auto grid = grid_from_json(j, assignment);
+        Puzzle puzzle(grid, bundles_from_json(j.value("bundles", json::array()), grid->get_max_ports()), name);
+        puzzle.set_assignment(std::move(assignment));
+        return puzzle;
+    }
+
+    // Задача из компактного формата (см. to_compact_json)
+    static Puzzle from_compact_json(const json& j, const std::string& name) {
+        if (j.value("version", 0) != COMPACT_FORMAT_VERSION) {
+            std::cerr << "Unsupported compact format version in " << name << std::endl;
+            return Puzzle(std::make_shared<Grid>(0, 0, GridType::SQUARE), std::vector<Bundle>{});
+        }
+        auto grid = PuzzleGenerator::create_grid((GridType)j.at("grid").at("type").get<int>(),
+                                                 j.at("grid").at("width"), j.at("grid").at("height"),
+                                                 (NodeOrder)j.at("grid").value("node_order", 0));
+        Assignment assignment(grid->size());
+        if (j.contains("bundle_id")) {
+            assignment.bundle_id = j.at("bundle_id").get<std::vector<int>>();
+            assignment.figure_id = j.at("figure_id").get<std::vector<int>>();
+        }
+
+        int ports_count = (int)grid->get_max_ports();
+        std::vector<Bundle> bundles;
+        for(const auto& b_json : j.at("bundles")) {
+            Color c = {b_json.at("color").at(0), b_json.at("color").at(1), b_json.at("color").at(2)};
+            std::vector<std::shared_ptr<Figure>> shapes;
+            for(const auto& s_json : b_json.at("shapes")) {
+                auto fig = std::make_shared<Figure>(s_json.at("name").get<std::string>(), ports_count);
+                std::vector<int> ports = s_json.at("ports").get<std::vector<int>>();
+                size_t size = ports.size() / ports_count;
+                fig->reserve(size);
+                for(size_t u = 0; u < size; ++u) fig->add_node();
+                for(size_t u = 0; u < size; ++u) {
+                    for(int p = 0; p < ports_count; ++p) {
+                        int v = ports[u * ports_count + p];
+                        if (v < -1 || v >= (int)size) throw std::out_of_range("shape port out of range");
+                        if (v != -1) fig->add_directed_edge((int)u, v, p);
+                    }
+                }
+                shapes.push_back(fig);
+            }
+            bundles.emplace_back(b_json.at("id").get<int>(), shapes, c);
+        }
 
+        Puzzle puzzle(grid, bundles, name);
+        puzzle.set_assignment(std::move(assignment));
+        return puzzle;
+    }
+
+    // Сетка (разделы "grid" и "cells") и решение из ее клеток
+    static std::shared_ptr<Grid> grid_from_json(const json& j, Assignment& assignment) {
         // 1. Восстановление Сетки
-        int w = j["grid"]["width"];
-        int h = j["grid"]["height"];
-        int t = j["grid"]["type"];
+        int w = j.at("grid").at("width");
+        int h = j.at("grid").at("height");
+        int t = j.at("grid").at("type");
         auto grid = std::make_shared<Grid>(w, h, (GridType)t);
 
-        // 2. Создание узлов (Cells)
-        for(const auto& cell : j["cells"]) {
-             GridCellData data(cell["x"], cell["y"]);
-             if(cell.contains("bundle_id")) data.bundle_id = cell["bundle_id"];
-             if(cell.contains("figure_id")) data.figure_id = cell["figure_id"];
-             grid->add_node(data);
+        // 2. Создание узлов (Cells) и решения
+        assignment = Assignment(j.at("cells").size());
+        for(const auto& cell : j.at("cells")) {
+             GridCellData data(cell.at("x"), cell.at("y"));
+             int nid = grid->add_node(data);
+             if(cell.contains("bundle_id")) assignment.bundle_id[nid] = cell.at("bundle_id");
+             if(cell.contains("figure_id")) assignment.figure_id[nid] = cell.at("figure_id");
         }
 
         // Восстановление связей (Ports)
-        for(const auto& cell : j["cells"]) {
-            int u = cell["id"];
+        for(const auto& cell : j.at("cells")) {
+            int u = cell.at("id");
             if (cell.contains("ports")) {
-                const auto& ports = cell["ports"];
+                const auto& ports = cell.at("ports");
                 for(int p=0; p < (int)ports.size(); ++p) {
                     int v = ports[p];
+                    if (v < -1 || v >= (int)grid->size()) throw std::out_of_range("cell port out of range");
                     if (v != -1) {
                         grid->add_directed_edge(u, v, p);
                     }
                 }
             } else if (cell.contains("neighbors")) {
                 int p = 0;
-                for(int v : cell["neighbors"]) {
+                for(int v : cell.at("neighbors")) {
+                    if (v < 0 || v >= (int)grid->size()) throw std::out_of_range("cell neighbor out of range");
                     grid->add_directed_edge(u, v, p++); 
                 }
             }
         }
 
+        // Таблица координаты -> id, если клетки в файле пронумерованы не по строкам
+        grid->index_nodes((NodeOrder)j.at("grid").value("node_order", 0));
+        return grid;
+    }
+
+    // Бандлы (раздел "bundles"); default_ports - число портов фигуры, если не указано
+    static std::vector<Bundle> bundles_from_json(const json& j_bundles, int default_ports) {
         // 3. Восстановление Бандлов
         std::vector<Bundle> bundles;
-        if(j.contains("bundles")) {
-            for(const auto& b_json : j["bundles"]) {
-                Color c = {255, 255, 255};
-                if(b_json.contains("color")) {
-                    c = {b_json["color"][0], b_json["color"][1], b_json["color"][2]};
-                }
-                int id = b_json["id"];
-                
-                std::vector<std::shared_ptr<Figure>> shapes;
-                if(b_json.contains("shapes")) {
-                    for(const auto& s_json : b_json["shapes"]) {
-                        std::string name = s_json["name"];
-                        int mp = s_json.contains("max_ports") ? (int)s_json["max_ports"] : grid->get_max_ports();
-                        
-                        auto fig = std::make_shared<Figure>(name, mp);
-                        
-                        if(s_json.contains("topology")) {
-                            for(const auto& node_json : s_json["topology"]) {
-                                fig->add_node(); 
-                            }
-                            for(const auto& node_json : s_json["topology"]) {
-                                int u = node_json["id"];
-                                const auto& ports = node_json["ports"];
-                                for(int p=0; p < (int)ports.size(); ++p) {
-                                    int v = ports[p];
-                                    if (v != -1) {
-                                        fig->add_directed_edge(u, v, p);
-                                    }
+        for(const auto& b_json : j_bundles) {
+            Color c = {255, 255, 255};
+            if(b_json.contains("color")) {
+                c = {b_json.at("color").at(0), b_json.at("color").at(1), b_json.at("color").at(2)};
+            }
+            int id = b_json.at("id");
+            
+            std::vector<std::shared_ptr<Figure>> shapes;
+            if(b_json.contains("shapes")) {
+                for(const auto& s_json : b_json.at("shapes")) {
+                    std::string name = s_json.at("name");
+                    int mp = s_json.contains("max_ports") ? (int)s_json.at("max_ports") : default_ports;
+                    
+                    auto fig = std::make_shared<Figure>(name, mp);
+                    
+                    if(s_json.contains("topology")) {
+                        for(const auto& node_json : s_json.at("topology")) {
+                            fig->add_node(); 
+                        }
+                        for(const auto& node_json : s_json.at("topology")) {
+                            int u = node_json.at("id");
+                            const auto& ports = node_json.at("ports");
+                            for(int p=0; p < (int)ports.size(); ++p) {
+                                int v = ports[p];
+                                if (v < -1 || v >= (int)fig->size()) throw std::out_of_range("shape port out of range");
+                                if (v != -1) {
+                                    fig->add_directed_edge(u, v, p);
                                 }
                             }
                         }
-                        shapes.push_back(fig);
                     }
+                    shapes.push_back(fig);
                 }
-                
-                Bundle b(id, shapes, c); 
-                bundles.push_back(b);
             }
+            
+            Bundle b(id, shapes, c); 
+            bundles.push_back(b);
         }
 
-        return Puzzle(grid, bundles, filename);
+        return bundles;
     }
     
-    static void save_json(const std::string& filename, std::shared_ptr<Grid> grid, const std::vector<Bundle>& bundles) {
-        save(Puzzle(grid, bundles), filename);
+    static void save_json(const std::string& filename, std::shared_ptr<const Grid> grid, const std::vector<Bundle>& bundles,
+                          const Assignment& assignment) {
+        Puzzle puzzle(grid, bundles);
+        puzzle.set_assignment(assignment);
+        save(puzzle, filename);
     }
 };
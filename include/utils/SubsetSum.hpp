@@ -0,0 +1,133 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Задача о сумме подмножеств (0/1-рюкзак с весом = ценностью) над площадями бандлов.
+//
+// Достижимые суммы 0..capacity - битовое множество по 64 суммы в слове; предмет веса w
+// добавляется сдвигом с ИЛИ (reach |= reach << w) только по словам до наибольшей
+// достигнутой суммы. Время O(предметы * capacity / 64), память O(capacity / 64).
+// Перебор заканчивается, как только достигнута сама capacity, или по сроку deadline.
+//
+// Подмножества восстанавливаются только для запрошенных сумм, обратным проходом по
+// предметам: предмет берется, если без него сумма недостижима префиксом до него.
+// Множества префиксов пересчитываются блоками от контрольных точек, сохраненных через
+// каждые ~sqrt(предметы) предметов, поэтому память остается O(sqrt(предметы) * capacity / 64).
+// При равных суммах в подмножество попадают более ранние в порядке обработки предметы.
+class SubsetSum {
+public:
+    using Clock = std::chrono::high_resolution_clock;
+
+private:
+    using Bits = std::vector<uint64_t>;
+
+    size_t capacity;
+    std::vector<int> items;          // обработанные предметы (индексы в weights), по порядку
+    std::vector<size_t> item_weight;
+    size_t block = 1;                // контрольная точка - перед каждым block-м предметом
+    std::vector<Bits> checkpoints;
+    Bits reach;
+    size_t reach_top = 0;            // наибольшая достигнутая сумма
+    size_t best_sum = 0;
+    bool finished = true;
+
+    bool test(const Bits& bits, size_t s) const { return (bits[s >> 6] >> (s & 63)) & 1; }
+
+    // bits |= bits << w по суммам не выше top
+    void shift_or(Bits& bits, size_t w, size_t top) const {
+        size_t word_shift = w >> 6, bit_shift = w & 63;
+        for (size_t k = top >> 6; k + 1 > word_shift; --k) {
+            size_t src = k - word_shift;
+            uint64_t v = bits[src] << bit_shift;
+            if (bit_shift != 0 && src > 0) v |= bits[src - 1] >> (64 - bit_shift);
+            bits[k] |= v;
+        }
+        // Биты выше capacity в последнем слове не хранятся
+        if ((capacity & 63) != 63) bits.back() &= (uint64_t(1) << ((capacity & 63) + 1)) - 1;
+    }
+
+public:
+    // weights - площади, order - порядок обработки предметов (индексы в weights).
+    // Если deadline наступил раньше конца перебора, complete() == false.
+    SubsetSum(const std::vector<size_t>& weights, const std::vector<int>& order, size_t capacity,
+              Clock::time_point deadline = Clock::time_point::max())
+        : capacity(capacity), reach(capacity / 64 + 1, 0) {
+        for (int i : order) {
+            if (weights[i] > 0 && weights[i] <= capacity) {
+                items.push_back(i);
+                item_weight.push_back(weights[i]);
+            }
+        }
+        while (block * block < items.size()) ++block;
+
+        reach[0] = 1; // пустое подмножество
+        bool check_time = deadline != Clock::time_point::max();
+        for (size_t t = 0; t < items.size(); ++t) {
+            if (test(reach, capacity)) {
+                items.resize(t); // остальные предметы не нужны: capacity уже достижима
+                item_weight.resize(t);
+                break;
+            }
+            if (check_time && Clock::now() > deadline) {
+                finished = false;
+                items.resize(t);
+                item_weight.resize(t);
+                break;
+            }
+            if (t % block == 0) checkpoints.push_back(reach);
+            reach_top = std::min(capacity, reach_top + item_weight[t]);
+            shift_or(reach, item_weight[t], reach_top);
+        }
+        for (size_t s = std::min(capacity, reach_top); s > 0; --s) {
+            if (test(reach, s)) {
+                best_sum = s;
+                break;
+            }
+        }
+    }
+
+    // Наибольшая достижимая сумма, не превышающая capacity. Если перебор прерван
+    // по сроку, это лишь достигнутая сумма, а не оценка сверху.
+    size_t best() const { return best_sum; }
+
+    // Перебор закончен (не прерван по сроку)
+    bool complete() const { return finished; }
+
+    bool reachable(size_t s) const { return s <= capacity && test(reach, s); }
+
+    // Подмножества (индексы в weights) для каждой из сумм sums; для недостижимой - пусто
+    std::vector<std::vector<int>> subsets(const std::vector<size_t>& sums) const {
+        std::vector<std::vector<int>> result(sums.size());
+        std::vector<size_t> left(sums.size(), 0);
+        for (size_t q = 0; q < sums.size(); ++q) {
+            if (reachable(sums[q])) left[q] = sums[q];
+        }
+
+        // Множества префиксов внутри блока: prefix[j] - до предмета first + j
+        std::vector<Bits> prefix;
+        for (size_t b = checkpoints.size(); b-- > 0;) {
+            size_t first = b * block;
+            size_t last = std::min(items.size(), first + block);
+            prefix.assign(1, checkpoints[b]);
+            size_t top = 0;
+            for (size_t t = 0; t < first; ++t) top = std::min(capacity, top + item_weight[t]);
+            for (size_t t = first; t + 1 < last; ++t) {
+                prefix.push_back(prefix.back());
+                top = std::min(capacity, top + item_weight[t]);
+                shift_or(prefix.back(), item_weight[t], top);
+            }
+            for (size_t t = last; t-- > first;) {
+                const Bits& before = prefix[t - first];
+                for (size_t q = 0; q < sums.size(); ++q) {
+                    if (left[q] == 0 || test(before, left[q])) continue;
+                    result[q].push_back(items[t]);
+                    left[q] -= item_weight[t];
+                }
+            }
+        }
+        return result;
+    }
+};
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Перемешивание 64-битного значения (splitmix64)
+inline uint64_t mix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Zobrist-ключи клеток: хеш занятости поля равен XOR ключей занятых клеток,
+// поэтому при установке/снятии фигуры он обновляется за O(размер фигуры).
+class ZobristKeys {
+private:
+    std::vector<uint64_t> keys;
+
+public:
+    explicit ZobristKeys(size_t cells, uint64_t seed = 0x5A0B2157ull) : keys(cells) {
+        std::mt19937_64 rng(seed);
+        for (auto& k : keys) k = rng();
+    }
+
+    uint64_t operator[](int cell) const { return keys[cell]; }
+
+    // Вклад набора клеток в хеш
+    uint64_t of(const std::vector<int>& cells) const {
+        uint64_t h = 0;
+        for (int c : cells) h ^= keys[c];
+        return h;
+    }
+};
+
+// Таблица транспозиций фиксированного размера с потерями.
+// Хранит только ключи "провальных" состояний: слот выбирается по младшим битам ключа,
+// новая запись просто вытесняет старую. Слоты атомарные, поэтому таблицу можно
+// разделять между потоками без блокировок.
+class TranspositionTable {
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    uint64_t mask = 0;
+
+public:
+    // size_log2 <= 0 отключает таблицу
+    explicit TranspositionTable(int size_log2) {
+        if (size_log2 <= 0) return;
+        size_t n = size_t(1) << size_log2;
+        slots.reset(new std::atomic<uint64_t>[n]());
+        mask = n - 1;
+    }
+
+    bool enabled() const { return slots != nullptr; }
+
+    bool contains(uint64_t key) const {
+        if (!slots) return false;
+        key = key ? key : 1; // 0 зарезервирован под пустой слот
+        return slots[key & mask].load(std::memory_order_relaxed) == key;
+    }
+
+    void insert(uint64_t key) {
+        if (!slots) return;
+        key = key ? key : 1;
+        slots[key & mask].store(key, std::memory_order_relaxed);
+    }
+};
@@ -0,0 +1,194 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Пул потоков с перехватом работы (work stealing).
+//
+// У каждого рабочего потока своя дека: spawn() из рабочего потока кладет задачу
+// в конец своей деки, сам поток берет задачи с конца (LIFO), а простаивающие
+// потоки крадут с начала чужих дек (FIFO). Есть еще общая очередь inject() с низшим
+// приоритетом: ее задачи выполняются только когда красть нечего. Так длинные задачи
+// верхнего уровня (например, итерации GRASP) не мешают мелким подзадачам.
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(int num_threads) {
+        if (num_threads < 1) num_threads = 1;
+        for (int i = 0; i < num_threads; ++i) {
+            queues.push_back(std::make_unique<Queue>());
+        }
+        for (int i = 0; i < num_threads; ++i) {
+            threads.emplace_back([this, i] { worker_loop(i); });
+        }
+    }
+
+    ~WorkStealingPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        sleep_cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int size() const { return (int)threads.size(); }
+
+    // Индекс текущего рабочего потока в этом пуле или -1
+    int current_worker() const { return tls_pool == this ? tls_index : -1; }
+
+    // Подзадача: в деку текущего потока (или в общую очередь, если вызвано извне)
+    void spawn(Task task) {
+        int self = current_worker();
+        if (self < 0) {
+            inject(std::move(task));
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(queues[self]->mutex);
+            queues[self]->tasks.push_back(std::move(task));
+        }
+        notify();
+    }
+
+    // Задача в общую очередь с низшим приоритетом
+    void inject(Task task) {
+        {
+            std::lock_guard<std::mutex> lock(global.mutex);
+            global.tasks.push_back(std::move(task));
+        }
+        notify();
+    }
+
+    // Выполнить одну задачу из своей деки или украденную у других.
+    // Общая очередь не трогается: так ожидающий поток не уйдет в чужую длинную задачу.
+    bool help_one() {
+        Task task;
+        if (!take_local_or_steal(current_worker(), task)) return false;
+        task();
+        return true;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    Queue global;
+    std::vector<std::thread> threads;
+    std::atomic<int> pending{0};
+    bool stopping = false;
+    std::mutex sleep_mutex;
+    std::condition_variable sleep_cv;
+
+    static inline thread_local const WorkStealingPool* tls_pool = nullptr;
+    static inline thread_local int tls_index = -1;
+
+    void notify() {
+        pending.fetch_add(1);
+        { std::lock_guard<std::mutex> lock(sleep_mutex); }
+        sleep_cv.notify_one();
+    }
+
+    bool pop_back(Queue& q, Task& out) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        out = std::move(q.tasks.back());
+        q.tasks.pop_back();
+        pending.fetch_sub(1);
+        return true;
+    }
+
+    bool pop_front(Queue& q, Task& out) {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) return false;
+        out = std::move(q.tasks.front());
+        q.tasks.pop_front();
+        pending.fetch_sub(1);
+        return true;
+    }
+
+    bool take_local_or_steal(int self, Task& out) {
+        if (self >= 0 && pop_back(*queues[self], out)) return true;
+        int n = (int)queues.size();
+        int start = self >= 0 ? self + 1 : 0;
+        for (int k = 0; k < n; ++k) {
+            int victim = (start + k) % n;
+            if (victim == self) continue;
+            if (pop_front(*queues[victim], out)) return true;
+        }
+        return false;
+    }
+
+    void worker_loop(int index) {
+        tls_pool = this;
+        tls_index = index;
+        while (true) {
+            Task task;
+            if (take_local_or_steal(index, task) || pop_front(global, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            if (stopping) break;
+            sleep_cv.wait_for(lock, std::chrono::milliseconds(5), [this] {
+                return stopping || pending.load() > 0;
+            });
+            if (stopping && pending.load() == 0) break;
+        }
+        tls_pool = nullptr;
+        tls_index = -1;
+    }
+};
+
+// Группа задач, завершения которых можно дождаться.
+// Рабочий поток пула во время ожидания выполняет чужие подзадачи, а не блокируется.
+class TaskGroup {
+public:
+    explicit TaskGroup(WorkStealingPool& pool) : pool(pool) {}
+
+    ~TaskGroup() { wait(); }
+
+    void spawn(WorkStealingPool::Task task) { pool.spawn(wrap(std::move(task))); }
+    void inject(WorkStealingPool::Task task) { pool.inject(wrap(std::move(task))); }
+
+    void wait() {
+        if (pool.current_worker() >= 0) {
+            while (remaining.load() > 0) {
+                if (!pool.help_one()) std::this_thread::yield();
+            }
+        }
+        // Захват мьютекса гарантирует, что завершившая задача уже вышла из wrap()
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [this] { return remaining.load() == 0; });
+    }
+
+private:
+    WorkStealingPool& pool;
+    std::atomic<int> remaining{0};
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    WorkStealingPool::Task wrap(WorkStealingPool::Task task) {
+        remaining.fetch_add(1);
+        return [this, task = std::move(task)] {
+            task();
+            std::lock_guard<std::mutex> lock(mutex);
+            if (remaining.fetch_sub(1) == 1) {
+                cv.notify_all();
+            }
+        };
+    }
+};
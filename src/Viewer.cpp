@@ -48,6 +48,7 @@ bool Viewer::loadData(const std::string& filename) {
         std::cout << "JSON parse complete." << std::endl;
         grid = puzzle.get_grid();
         bundles = puzzle.get_bundles();
+        assignment = puzzle.get_assignment();
         
         if (!grid) {
             std::cerr << "Error loading grid!" << std::endl;
@@ -226,14 +227,14 @@ sf::Vector2f Viewer::getNodePosition(int x, int y, GridType type) {
 bool Viewer::drawGrid() {
     int hoveredBundleId = -1;
     if (hoveredNodeId != -1 && grid) {
-        hoveredBundleId = grid->get_node(hoveredNodeId).get_data().bundle_id;
+        hoveredBundleId = assignment.bundle_id[hoveredNodeId];
     }
 
     sf::Color gridLineColor(100, 100, 100); 
     float outlineThick = 1.0f; 
 
     for (auto const& node : grid->get_nodes()) {
-        int bid = node.get_data().bundle_id;
+        int bid = assignment.bundle_id[node.get_id()];
         
         sf::Color cellColor = sf::Color(60, 60, 60);
         if (bid != -1 && bundleColors.count(bid)) {
@@ -0,0 +1,189 @@
+#include "solvers.h"
+#include "generators.h"
+#include "utils/RclReservoir.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Проверки инвариантов, которые солвер поддерживает инкрементально, против
+// медленных эталонов. Запускается через ctest (solver_checks); код возврата 0 - все сошлось.
+struct SolverChecks {
+    // Частоты, с которыми каждый кандидат попадает в выборку и оказывается в ней первым
+    struct Frequencies {
+        std::vector<double> included;
+        std::vector<double> first;
+    };
+
+    // Эталон RclReservoir: собрать всех кандидатов -> оставить score >= alpha * max_score ->
+    // перемешать -> взять первые k
+    static std::vector<int> full_rcl(const std::vector<int>& scores, size_t k, float alpha, std::mt19937& rng) {
+        int max_score = *std::max_element(scores.begin(), scores.end());
+        std::vector<int> rcl;
+        for (size_t i = 0; i < scores.size(); ++i) {
+            if (max_score <= 0 || scores[i] >= max_score * alpha) rcl.push_back((int)i);
+        }
+        std::shuffle(rcl.begin(), rcl.end(), rng);
+        if (rcl.size() > k) rcl.resize(k);
+        return rcl;
+    }
+
+    static std::vector<int> reservoir(const std::vector<int>& scores, size_t k, float alpha, std::mt19937& rng) {
+        RclReservoir<int> rcl(k, alpha);
+        for (size_t i = 0; i < scores.size(); ++i) {
+            rcl.offer(scores[i], [&]() { return (int)i; }, rng);
+        }
+        return rcl.take(rng);
+    }
+
+    template <class Sample>
+    static Frequencies frequencies(const std::vector<int>& scores, size_t k, float alpha, int trials,
+                                   uint32_t seed, Sample sample) {
+        std::mt19937 rng(seed);
+        Frequencies f{std::vector<double>(scores.size(), 0.0), std::vector<double>(scores.size(), 0.0)};
+        for (int t = 0; t < trials; ++t) {
+            std::vector<int> picked = sample(scores, k, alpha, rng);
+            if (!picked.empty()) f.first[picked[0]] += 1.0 / trials;
+            for (int i : picked) f.included[i] += 1.0 / trials;
+        }
+        return f;
+    }
+
+    // RclReservoir и полный RCL на одном потоке кандидатов: одинаковые размеры выборки
+    // и одинаковые (в пределах шума) частоты попадания и первого места у каждого кандидата
+    static int check_rcl_reservoir() {
+        std::mt19937 gen(7);
+        int failures = 0;
+        const int trials = 40000;
+        for (int c = 0; c < 12; ++c) {
+            size_t n = 5 + gen() % 40;
+            size_t k = 1 + gen() % 8;
+            float alpha = std::vector<float>{0.5f, 0.8f, 0.9f, 1.0f}[c % 4];
+            std::vector<int> scores(n);
+            for (size_t i = 0; i < n; ++i) {
+                switch (c % 3) {
+                    case 0: scores[i] = (int)(gen() % 10) * 10; break;       // повторяющиеся значения
+                    case 1: scores[i] = (int)i * 3 + (int)(gen() % 5); break; // растущий максимум
+                    default: scores[i] = -(int)(gen() % 6); break;           // max <= 0: проходят все
+                }
+            }
+
+            std::mt19937 size_rng(c);
+            for (int t = 0; t < 50; ++t) {
+                if (full_rcl(scores, k, alpha, size_rng).size() != reservoir(scores, k, alpha, size_rng).size()) {
+                    std::cerr << "RclReservoir: sample size differs from the full RCL (case " << c << ")" << std::endl;
+                    failures++;
+                    break;
+                }
+            }
+
+            Frequencies expected = frequencies(scores, k, alpha, trials, 100 + c, full_rcl);
+            Frequencies actual = frequencies(scores, k, alpha, trials, 200 + c, reservoir);
+            for (size_t i = 0; i < n; ++i) {
+                // Допуск - около 5 стандартных отклонений разности двух частот
+                auto tolerance = [&](double p) { return 5.0 * std::sqrt(2.0 * p * (1.0 - p) / trials) + 1e-9; };
+                if (std::abs(expected.included[i] - actual.included[i]) > tolerance(expected.included[i]) ||
+                    std::abs(expected.first[i] - actual.first[i]) > tolerance(expected.first[i])) {
+                    std::cerr << "RclReservoir: candidate " << i << " (score " << scores[i] << ") drawn with "
+                              << actual.included[i] << "/" << actual.first[i] << ", full RCL "
+                              << expected.included[i] << "/" << expected.first[i] << " (case " << c << ")" << std::endl;
+                    failures++;
+                }
+            }
+        }
+        return failures;
+    }
+
+    // Счетчики contacts и фронт после серии occupy/release против пересчета с нуля
+    static int check_board(const GRASPSolver& solver, const GRASPSolver::BoardState& board) {
+        const auto& nodes = solver.graph->get_nodes();
+        size_t ports = solver.graph->get_max_ports();
+        bool frontier = solver.config.enumeration == CandidateEnumeration::FRONTIER;
+        int failures = 0;
+        size_t frontier_size = 0;
+        for (size_t c = 0; c < nodes.size(); ++c) {
+            int contacts = 0;
+            for (size_t p = 0; p < ports; ++p) {
+                int n = nodes[c].get_neighbor(p);
+                if (n == -1 || board.occupied[n]) contacts++;
+            }
+            if (board.contacts[c] != contacts) failures++;
+            if (!frontier) continue;
+            bool expected = !board.occupied[c] && contacts > 0;
+            int pos = board.frontier_pos[c];
+            bool listed = pos != -1 && pos < (int)board.frontier.size() && board.frontier[pos] == (int)c;
+            if (expected != listed || (!listed && pos != -1)) failures++;
+            frontier_size += expected;
+        }
+        if (frontier && frontier_size != board.frontier.size()) failures++;
+        return failures;
+    }
+
+    static int check_contacts() {
+        int failures = 0;
+        std::mt19937 rng(11);
+        const GridType types[] = {GridType::SQUARE, GridType::HEXAGON, GridType::TRIANGLE};
+        for (GridType type : types) {
+            for (CandidateEnumeration enumeration : {CandidateEnumeration::FULL, CandidateEnumeration::FRONTIER}) {
+                auto grid = PuzzleGenerator::create_grid(type, 17, 13);
+                Puzzle puzzle(grid, std::vector<Bundle>{});
+                SolverConfig cfg;
+                cfg.enumeration = enumeration;
+                GRASPSolver solver(puzzle, cfg);
+                GRASPSolver::BoardState board = solver.make_empty_board();
+                const auto& nodes = grid->get_nodes();
+
+                // Случайные связные следы до 5 клеток ставятся и снимаются в порядке стека,
+                // как при переборе с возвратом; иногда снимается и несколько подряд
+                std::vector<std::vector<int>> placed;
+                int board_failures = 0;
+                for (int step = 0; step < 3000; ++step) {
+                    if (!placed.empty() && rng() % 3 == 0) {
+                        solver.release(board, placed.back());
+                        placed.pop_back();
+                    } else {
+                        int start = (int)(rng() % grid->size());
+                        if (board.occupied[start]) continue;
+                        std::vector<int> footprint = {start};
+                        std::vector<char> taken(grid->size(), 0);
+                        taken[start] = 1;
+                        size_t want = 1 + rng() % 5;
+                        for (size_t i = 0; i < footprint.size() && footprint.size() < want; ++i) {
+                            for (int n : nodes[footprint[i]].get_all_neighbors()) {
+                                if (n == -1 || board.occupied[n] || taken[n] || footprint.size() >= want) continue;
+                                taken[n] = 1;
+                                footprint.push_back(n);
+                            }
+                        }
+                        solver.occupy(board, footprint);
+                        placed.push_back(footprint);
+                    }
+                    board_failures += check_board(solver, board);
+                }
+                while (!placed.empty()) {
+                    solver.release(board, placed.back());
+                    placed.pop_back();
+                }
+                board_failures += check_board(solver, board);
+                if (board_failures > 0) {
+                    std::cerr << "Contacts: " << board_failures << " mismatches on grid type " << (int)type
+                              << (enumeration == CandidateEnumeration::FRONTIER ? " (frontier)" : "") << std::endl;
+                }
+                failures += board_failures;
+            }
+        }
+        return failures;
+    }
+};
+
+int main() {
+    int failures = 0;
+    int rcl = SolverChecks::check_rcl_reservoir();
+    std::cout << "RclReservoir vs full RCL: " << (rcl == 0 ? "OK" : "FAILED") << std::endl;
+    failures += rcl;
+    int contacts = SolverChecks::check_contacts();
+    std::cout << "Incremental contacts vs rescan: " << (contacts == 0 ? "OK" : "FAILED") << std::endl;
+    failures += contacts;
+    return failures == 0 ? 0 : 1;
+}
@@ -1,6 +1,8 @@
 #include "core.hpp"
 #include <vector>
 #include <queue>
+#include <algorithm>
+#include <cstdint>
 
 
 std::vector<int> Grid::get_embedding(std::shared_ptr<Figure> figure, int anchor_id, int rotation) const {
@@ -44,6 +46,97 @@ std::vector<int> Grid::get_embedding(std::shared_ptr<Figure> figure, int anchor_
     return mapping;
 }
 
+std::shared_ptr<Grid> Grid::extract_subgrid(const std::vector<int>& cells) const {
+    auto sub = std::make_shared<Grid>(width, height, type);
+    std::vector<int> global_to_local(this->size(), -1);
+    for (int gid : cells) {
+        const GridCellData& d = this->get_node(gid).get_data();
+        global_to_local[gid] = sub->add_node(GridCellData(d.x, d.y));
+    }
+    for (int gid : cells) {
+        const auto& node = this->get_node(gid);
+        for (size_t p = 0; p < this->get_max_ports(); ++p) {
+            int n = node.get_neighbor(p);
+            if (n != -1 && global_to_local[n] != -1) {
+                sub->add_directed_edge(global_to_local[gid], global_to_local[n], p);
+            }
+        }
+    }
+    return sub;
+}
+
+// Индекс клетки на кривой Гильберта в квадрате side x side (side - степень двойки)
+static uint64_t hilbert_index(uint64_t side, uint64_t x, uint64_t y) {
+    uint64_t d = 0;
+    for (uint64_t s = side / 2; s > 0; s /= 2) {
+        uint64_t rx = (x & s) > 0;
+        uint64_t ry = (y & s) > 0;
+        d += s * s * ((3 * rx) ^ ry);
+        // Поворот четверти, чтобы кривая внутри нее начиналась у общего края
+        if (ry == 0) {
+            if (rx == 1) {
+                x = side - 1 - x;
+                y = side - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Индекс Z-order: биты x и y через один
+static uint64_t morton_index(uint64_t x, uint64_t y) {
+    uint64_t d = 0;
+    for (int b = 0; b < 32; ++b) {
+        d |= ((x >> b) & 1) << (2 * b);
+        d |= ((y >> b) & 1) << (2 * b + 1);
+    }
+    return d;
+}
+
+std::vector<int> Grid::make_numbering(NodeOrder order, int width, int height) {
+    size_t n = (size_t)width * height;
+    std::vector<int> ids(n);
+    if (order == NodeOrder::ROW_MAJOR) {
+        for (size_t i = 0; i < n; ++i) ids[i] = (int)i;
+        return ids;
+    }
+
+    // Кривая строится в квадрате со стороной-степенью двойки; у прямоугольника индексы
+    // идут с пропусками, поэтому id - ранг клетки после сортировки по индексу
+    uint64_t side = 1;
+    while (side < (uint64_t)std::max(width, height)) side *= 2;
+    std::vector<std::pair<uint64_t, int>> keys(n);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            uint64_t key = order == NodeOrder::HILBERT ? hilbert_index(side, x, y) : morton_index(x, y);
+            keys[(size_t)y * width + x] = {key, y * width + x};
+        }
+    }
+    std::sort(keys.begin(), keys.end());
+    for (size_t rank = 0; rank < n; ++rank) ids[keys[rank].second] = (int)rank;
+    return ids;
+}
+
+void Grid::index_nodes(NodeOrder node_order) {
+    order = node_order;
+    id_at.clear();
+    bool row_major = true;
+    for (const auto& node : nodes) {
+        const GridCellData& d = node.get_data();
+        if (d.y * width + d.x != node.get_id()) {
+            row_major = false;
+            break;
+        }
+    }
+    if (row_major) return;
+    id_at.assign((size_t)width * height, -1);
+    for (const auto& node : nodes) {
+        const GridCellData& d = node.get_data();
+        if (d.x >= 0 && d.x < width && d.y >= 0 && d.y < height) id_at[(size_t)d.y * width + d.x] = node.get_id();
+    }
+}
+
 Bundle::Bundle(int id, std::vector<std::shared_ptr<Figure>> shapes, const Color& color)
     : id(id), shapes(std::move(shapes)), color(color) {
     recalculate_area();
@@ -57,14 +150,11 @@ void Bundle::recalculate_area() {
 }
 
 Puzzle Puzzle::clone() const {
-    auto new_grid = std::make_shared<Grid>(*grid); 
-    return Puzzle(new_grid, bundles, name);
+    Puzzle copy(grid, bundles, name);
+    copy.assignment = assignment;
+    return copy;
 }
 
 void Puzzle::clear_grid() {
-    if (!grid) return;
-    for (auto& node : grid->get_nodes()) {
-        node.get_data().bundle_id = -1;
-        node.get_data().figure_id = -1;
-    }
+    assignment.clear();
 }
@@ -0,0 +1,174 @@
+#include "corpus.h"
+#include "generators.h"
+#include "utils/Serializer.hpp"
+#include "utils/Timer.hpp"
+#include "utils/WorkStealingPool.hpp"
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+
+namespace {
+
+// Список пар [a, b] из перебора или значение по умолчанию
+std::vector<std::pair<int, int>> read_pairs(const json& sweep, const char* key, std::pair<int, int> fallback) {
+    std::vector<std::pair<int, int>> pairs;
+    if (sweep.contains(key)) {
+        for (const auto& item : sweep[key]) pairs.emplace_back(item[0].get<int>(), item[1].get<int>());
+    }
+    if (pairs.empty()) pairs.push_back(fallback);
+    return pairs;
+}
+
+const char* grid_type_name(GridType type) {
+    switch (type) {
+        case GridType::HEXAGON: return "hex";
+        case GridType::TRIANGLE: return "tri";
+        case GridType::SQUARE: default: return "sq";
+    }
+}
+
+// Имя файла экземпляра (без расширения): все параметры, чтобы корпуса можно было сливать
+std::string instance_name(const GeneratorConfig& cfg) {
+    return std::string(grid_type_name(cfg.grid_type)) + "_" + std::to_string(cfg.width) + "x" +
+           std::to_string(cfg.height) + "_s" + std::to_string(cfg.min_shape_size) + "-" +
+           std::to_string(cfg.max_shape_size) + "_b" + std::to_string(cfg.min_bundle_area) + "-" +
+           std::to_string(cfg.max_bundle_area) + "_seed" + std::to_string(cfg.seed);
+}
+
+} // namespace
+
+int run_corpus(const CorpusOptions& options) {
+    std::ifstream in(options.sweep_path);
+    if (!in.is_open()) {
+        std::cerr << "Failed to open sweep file: " << options.sweep_path << std::endl;
+        return 1;
+    }
+    json sweep;
+    try {
+        in >> sweep;
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing sweep: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // 1. Все сочетания параметров
+    std::vector<GeneratorConfig> instances;
+    try {
+        auto sizes = read_pairs(sweep, "sizes", {20, 20});
+        auto shape_sizes = read_pairs(sweep, "shape_sizes", {3, 5});
+        auto bundle_areas = read_pairs(sweep, "bundle_areas", {15, 25});
+        std::vector<int> grid_types = sweep.value("grid_types", std::vector<int>{0});
+        std::vector<uint64_t> seeds = sweep.value("seeds", std::vector<uint64_t>{1, 1});
+        if (seeds.size() != 2 || seeds[0] == 0 || seeds[0] > seeds[1]) {
+            std::cerr << "\"seeds\" must be [first, last] with 0 < first <= last" << std::endl;
+            return 1;
+        }
+
+        for (auto size : sizes)
+        for (int type : grid_types)
+        for (auto shape : shape_sizes)
+        for (auto area : bundle_areas)
+        for (uint64_t seed = seeds[0]; seed <= seeds[1]; ++seed) {
+            GeneratorConfig cfg;
+            cfg.width = size.first;
+            cfg.height = size.second;
+            cfg.grid_type = (GridType)type;
+            cfg.min_shape_size = shape.first;
+            cfg.max_shape_size = shape.second;
+            cfg.min_bundle_area = area.first;
+            cfg.max_bundle_area = area.second;
+            cfg.seed = seed;
+            cfg.threads = 1; // параллелизм - по экземплярам
+            if (sweep.contains("tile_size")) cfg.tile_size = sweep["tile_size"];
+            if (sweep.contains("node_order")) cfg.node_order = (NodeOrder)sweep["node_order"].get<int>();
+            instances.push_back(cfg);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error parsing sweep: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(options.output_dir, ec);
+    if (ec) {
+        std::cerr << "Failed to create output directory " << options.output_dir << ": " << ec.message() << std::endl;
+        return 1;
+    }
+
+    // 2. Генерация. Строки манифеста - по индексу экземпляра, поэтому порядок в нем
+    // не зависит от порядка завершения задач
+    Timer timer;
+    std::vector<json> entries(instances.size());
+    std::atomic<size_t> failed{0};
+    {
+        WorkStealingPool workers(options.threads);
+        TaskGroup group(workers);
+        for (size_t i = 0; i < instances.size(); ++i) {
+            group.inject([&, i]() {
+                const GeneratorConfig& cfg = instances[i];
+                PuzzleGenerator generator(cfg);
+                Puzzle target = generator.generate();
+
+                std::string name = instance_name(cfg);
+                std::string task_file = name + ".json";
+                std::string target_file = name + "_target.json";
+                Puzzle task = target.clone();
+                task.clear_grid();
+
+                std::filesystem::path dir(options.output_dir);
+                if (!Serializer::save_compact(target, (dir / target_file).string()) ||
+                    !Serializer::save_compact(task, (dir / task_file).string())) {
+                    failed++;
+                    return;
+                }
+
+                size_t optimal = 0;
+                for (const auto& b : target.get_bundles()) optimal += b.get_total_area();
+                entries[i] = {
+                    {"file", task_file},
+                    {"target", target_file},
+                    {"seed", cfg.seed},
+                    {"width", cfg.width},
+                    {"height", cfg.height},
+                    {"grid_type", (int)cfg.grid_type},
+                    {"min_shape_size", cfg.min_shape_size},
+                    {"max_shape_size", cfg.max_shape_size},
+                    {"min_bundle_area", cfg.min_bundle_area},
+                    {"max_bundle_area", cfg.max_bundle_area},
+                    {"tile_size", cfg.tile_size},
+                    {"node_order", (int)cfg.node_order},
+                    {"cells", target.get_grid()->size()},
+                    {"bundles", target.get_bundles().size()},
+                    {"optimal_score", optimal}
+                };
+            });
+        }
+        group.wait();
+    }
+
+    // 3. Манифест
+    json manifest;
+    manifest["format"] = "compact";
+    manifest["version"] = Serializer::COMPACT_FORMAT_VERSION;
+    manifest["instances"] = json::array();
+    for (auto& entry : entries) {
+        if (!entry.is_null()) manifest["instances"].push_back(std::move(entry));
+    }
+    std::string manifest_path = (std::filesystem::path(options.output_dir) / "manifest.json").string();
+    std::ofstream out(manifest_path);
+    if (!out.is_open()) {
+        std::cerr << "Failed to write manifest: " << manifest_path << std::endl;
+        return 1;
+    }
+    out << manifest.dump(2);
+
+    std::cout << "Generated " << manifest["instances"].size() << " instances in "
+              << timer.get_elapsed_sec() << " s: " << manifest_path << std::endl;
+    if (failed > 0) {
+        std::cerr << failed.load() << " instances failed to save" << std::endl;
+        return 1;
+    }
+    return 0;
+}
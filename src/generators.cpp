@@ -1,49 +1,61 @@
 #include "generators.h"
 #include "utils/ColorUtils.hpp"
+#include "utils/WorkStealingPool.hpp"
 #include <random>
 #include <algorithm>
 #include <set>
 #include <iostream>
 #include <queue>
 #include <cmath>
-#include <unordered_map>
 #include <optional>
 
 PuzzleGenerator::PuzzleGenerator(const GeneratorConfig& cfg) : config(cfg) {
-    std::random_device rd;
-    rng.seed(rd());
+    seed = cfg.seed;
+    if (seed == 0) {
+        std::random_device rd;
+        seed = ((uint64_t)rd() << 32) | rd();
+    }
+    std::seed_seq seq{(uint32_t)seed, (uint32_t)(seed >> 32)};
+    rng.seed(seq);
 }
 
-std::shared_ptr<Grid> PuzzleGenerator::create_square_grid() {
-    auto g = std::make_shared<Grid>(config.width, config.height, GridType::SQUARE);
-    
-    for(int y=0; y<config.height; ++y) {
-        for(int x=0; x<config.width; ++x) {
-            g->add_node(GridCellData(x, y));
-        }
-    }
-    
-    for(int y=0; y<config.height; ++y) {
-        for(int x=0; x<config.width; ++x) {
-            int id = y*config.width + x;
-            // Связь вправо (порт 1 у текущего, порт 3 у соседа)
-            if(x < config.width - 1) g->add_edge(id, y*config.width+(x+1), 1, 3); 
-            // Связь вниз (порт 2 у текущего, порт 0 у соседа)
-            if(y < config.height - 1) g->add_edge(id, (y+1)*config.width+x, 2, 0); 
+std::shared_ptr<Grid> PuzzleGenerator::create_grid(GridType type, int width, int height, NodeOrder order) {
+    auto g = std::make_shared<Grid>(width, height, type);
+    g->reserve((size_t)width * height);
+
+    // Узлы добавляются в порядке нумерации: id[y * width + x] - номер клетки (x, y)
+    std::vector<int> id = Grid::make_numbering(order, width, height);
+    std::vector<GridCellData> cells((size_t)width * height);
+    for(int y=0; y<height; ++y) {
+        for(int x=0; x<width; ++x) {
+            cells[id[(size_t)y*width + x]] = GridCellData(x, y);
         }
     }
+    for(const auto& cell : cells) g->add_node(cell);
+
+    if (type == GridType::HEXAGON) connect_hex_grid(*g, id);
+    else if (type == GridType::TRIANGLE) connect_triangle_grid(*g, id);
+    else connect_square_grid(*g, id);
+
+    g->index_nodes(order);
     return g;
 }
 
-std::shared_ptr<Grid> PuzzleGenerator::create_hex_grid() {
-    auto g = std::make_shared<Grid>(config.width, config.height, GridType::HEXAGON);
-
-    for(int y=0; y<config.height; ++y) {
-        for(int x=0; x<config.width; ++x) {
-            g->add_node(GridCellData(x, y));
+void PuzzleGenerator::connect_square_grid(Grid& g, const std::vector<int>& id) {
+    int width = g.get_width(), height = g.get_height();
+    for(int y=0; y<height; ++y) {
+        for(int x=0; x<width; ++x) {
+            int u = id[y*width + x];
+            // Связь вправо (порт 1 у текущего, порт 3 у соседа)
+            if(x < width - 1) g.add_edge(u, id[y*width+(x+1)], 1, 3); 
+            // Связь вниз (порт 2 у текущего, порт 0 у соседа)
+            if(y < height - 1) g.add_edge(u, id[(y+1)*width+x], 2, 0); 
         }
     }
+}
 
+void PuzzleGenerator::connect_hex_grid(Grid& g, const std::vector<int>& id) {
+    int width = g.get_width(), height = g.get_height();
     
     // Как уже обсуждалось ранее, соседи у шестиугольника определяются так же как и у квадрата, только со смешением, существует биекция
     int er_dx[] = {0, 1, 0, -1, -1, -1};
@@ -51,9 +63,9 @@ std::shared_ptr<Grid> PuzzleGenerator::create_hex_grid() {
     int or_dx[] = {1, 1, 1, 0, -1, 0};
     int or_dy[] = {-1, 0, 1, 1, 0, -1};
 
-    for(int y=0; y<config.height; ++y) {
-        for(int x=0; x<config.width; ++x) {
-            int id = y*config.width + x;
+    for(int y=0; y<height; ++y) {
+        for(int x=0; x<width; ++x) {
+            int u = id[y*width + x];
             int* dx = (y % 2 == 0) ? er_dx : or_dx;
             int* dy = (y % 2 == 0) ? er_dy : or_dy;
 
@@ -61,210 +73,260 @@ std::shared_ptr<Grid> PuzzleGenerator::create_hex_grid() {
                 int nx = x + dx[p];
                 int ny = y + dy[p];
                 
-                if (nx >= 0 && nx < config.width && ny >= 0 && ny < config.height) {
-                    int nid = ny * config.width + nx;
+                if (nx >= 0 && nx < width && ny >= 0 && ny < height) {
                     // p - выходной порт, (p+3)%6 - входной (противоположный)
-                    g->add_edge(id, nid, p, (p+3)%6);
+                    g.add_edge(u, id[ny * width + nx], p, (p+3)%6);
                 }
             }
         }
     }
-    return g;
 }
 
-std::shared_ptr<Grid> PuzzleGenerator::create_triangle_grid() {
-    auto g = std::make_shared<Grid>(config.width, config.height, GridType::TRIANGLE);
-    
-    for(int y=0; y<config.height; ++y) {
-        for(int x=0; x<config.width; ++x) {
-            g->add_node(GridCellData(x, y));
-        }
-    }
+void PuzzleGenerator::connect_triangle_grid(Grid& g, const std::vector<int>& id) {
+    int width = g.get_width(), height = g.get_height();
 
-    for(int y=0; y<config.height; ++y) {
-        for(int x=0; x<config.width; ++x) {
-            int id = y*config.width + x;
+    for(int y=0; y<height; ++y) {
+        for(int x=0; x<width; ++x) {
+            int u = id[y*width + x];
             bool is_up = ((x + y) % 2 == 0); // Треугольники чередуются (острием вверх/вниз)
             
             // Горизонтальная связь
-            if (x < config.width - 1) g->add_edge(id, y*config.width + (x+1), 0, 1); 
+            if (x < width - 1) g.add_edge(u, id[y*width + (x+1)], 0, 1); 
             
             // Вертикальная связь зависит от ориентации
             if (is_up) {
-                if (y < config.height - 1) g->add_edge(id, (y+1)*config.width + x, 2, 2); 
+                if (y < height - 1) g.add_edge(u, id[(y+1)*width + x], 2, 2); 
             } else {
-                if (y > 0) g->add_edge(id, (y-1)*config.width + x, 2, 2); 
+                if (y > 0) g.add_edge(u, id[(y-1)*width + x], 2, 2); 
             }
         }
     }
-    return g;
 }
 
-// Преобразование набора клеток по коордам сетки в объект Figure сохраняя топологию
-std::shared_ptr<Figure> PuzzleGenerator::subset_to_figure(std::string name, const std::vector<int>& node_ids, std::shared_ptr<Grid> grid) {
-    // 1. Создаем пустую фигуру
-    auto fig = std::make_shared<Figure>(name, grid->get_max_ports());
-    
-    // отображение для локального удобства (Сетка -> Фигура) понижение номеров/сжатие координат
-    std::unordered_map<int, int> grid_to_fig;
-    
-    for (int gid : node_ids) {
-        int fid = fig->add_node(); 
-        grid_to_fig[gid] = fid;
+// Разбиение прямоугольника area на фигуры
+void PuzzleGenerator::partition_area(const Grid& grid, Partition& part, GrowArea& area) {
+    // Оптимизация: Используем вектор для пула свободных узлов (для рандома)
+    std::vector<int> available_nodes_pool;
+    available_nodes_pool.reserve((size_t)(area.x1 - area.x0) * (area.y1 - area.y0));
+    for(int y = area.y0; y < area.y1; ++y) {
+        for(int x = area.x0; x < area.x1; ++x) {
+            available_nodes_pool.push_back(grid.get_node_id_at(x, y));
+        }
     }
-    
-    for (int gid : node_ids) {
-        const auto& g_node = grid->get_node(gid);
-        int fid = grid_to_fig[gid];
+    area.growth.reserve(config.max_shape_size);
+    area.neighbors.reserve(grid.get_max_ports());
+
+    std::uniform_int_distribution<> size_dist(config.min_shape_size, config.max_shape_size);
+
+    while(!available_nodes_pool.empty()) {
+        // Быстрый выбор случайного:
+        std::uniform_int_distribution<> dis(0, available_nodes_pool.size()-1);
+        int rand_idx = dis(area.rng);
+        int start = available_nodes_pool[rand_idx];
         
-        for (int p=0; p < grid->get_max_ports(); ++p) {
-            int neighbor_gid = g_node.get_neighbor(p);
-            
-            if (neighbor_gid != -1 && grid_to_fig.count(neighbor_gid)) {
-                int neighbor_fid = grid_to_fig[neighbor_gid];
-                fig->add_directed_edge(fid, neighbor_fid, p); // мы перебираем ВСЕ ноды, поэтому можем не искать обратный порт
-            }
-        }
+        // Swap-and-pop
+        available_nodes_pool[rand_idx] = available_nodes_pool.back();
+        available_nodes_pool.pop_back();
+
+        // Попытка вырастить фигуру
+        int target_size = size_dist(area.rng);
+        grow_region(start, target_size, grid, part, area);
     }
-    
-    return fig;
+
+    // Слияние мелких остатков (Merge) - на месте
+    merge_small_shapes(part, grid, area);
 }
 
 // Выращивание одной фигуры 
-std::optional<std::vector<int>> PuzzleGenerator::grow_region(int start_node, int target_size, std::shared_ptr<Grid> grid, std::vector<char>& is_free) {
-    if (!is_free[start_node]) return std::nullopt;
-
-    // Используем set для уникальности и vector для рандомного выбора
-    // Но так как target_size маленький (обычно < 10), можно оптимизировать
-    std::vector<int> current_shape = {start_node};
-    std::vector<int> growth = {start_node}; 
-    is_free[start_node] = 0; 
-    
-    // Вспомогательный set для быстрой проверки пренадлежности тикущщей фигуре
-    std::unordered_map<int, bool> in_shape; 
-    in_shape[start_node] = true;
-
-    while((int)current_shape.size() < target_size && !growth.empty()) {
-        int grow_from;
-        if (std::uniform_real_distribution<>(0, 1)(rng) < 0.6) { // в приоритете сложность, а значит делаем змею, вероятнее идем из самой свежей вершины
-            grow_from = growth.back();
+bool PuzzleGenerator::grow_region(int start_node, int target_size, const Grid& grid, Partition& part, GrowArea& area) {
+    if (part.label[start_node] != -1) return false;
+
+    // Клетки фигуры сразу получают ее метку, поэтому отдельное множество принадлежности
+    // не нужно. growth и neighbors - буферы area.
+    int shape = start_node;
+    part.tail[shape] = start_node;
+    part.area[shape] = 1;
+    part.parent[shape] = shape;
+    part.label[start_node] = shape;
+    std::vector<int>& growth = area.growth;
+    std::vector<int>& neighbors = area.neighbors;
+    growth.clear();
+    growth.push_back(start_node);
+
+    while(part.area[shape] < target_size && !growth.empty()) {
+        size_t from_idx;
+        if (std::uniform_real_distribution<>(0, 1)(area.rng) < 0.6) { // в приоритете сложность, а значит делаем змею, вероятнее идем из самой свежей вершины
+            from_idx = growth.size() - 1;
         } else {
             std::uniform_int_distribution<> g_dist(0, growth.size()-1);
-            grow_from = growth[g_dist(rng)];
+            from_idx = g_dist(area.rng);
         }
+        int grow_from = growth[from_idx];
 
-        // Ищем свободных соседей
-        std::vector<int> valid_neighbors;
-        for(int p=0; p < grid->get_max_ports(); ++p) {
-            int n = grid->get_node(grow_from).get_neighbor(p);
+        // Ищем свободных соседей (только внутри area: за ее границей растут другие потоки)
+        neighbors.clear();
+        const auto& node = grid.get_node(grow_from);
+        for(int p=0; p < grid.get_max_ports(); ++p) {
+            int n = node.get_neighbor(p);
 
-            if (n != -1 && is_free[n] && !in_shape.count(n)) {
-                valid_neighbors.push_back(n);
+            if (n != -1 && area.contains(grid.get_node(n).get_data()) && part.label[n] == -1) {
+                neighbors.push_back(n);
             }
         }
 
-        if(valid_neighbors.empty()) {
-            // ТПоскольку мы не нашли соседей, значит из этой вершины перейти в следующую уже нельзя, можно удалить
-            if (std::find(growth.begin(), growth.end(), grow_from) != growth.end()) {
-                    auto it = std::find(growth.begin(), growth.end(), grow_from);
-                    if (it != growth.end()) growth.erase(it);
-            }
+        if(neighbors.empty()) {
+            // Поскольку мы не нашли соседей, значит из этой вершины перейти в следующую уже нельзя, можно удалить.
+            // growth упорядочен по свежести (на нем держится выбор последней вершины), поэтому
+            // удаление из середины сдвигает хвост, а не переносит на это место последнюю вершину.
+            // Чаще всего удаляется как раз последняя - это O(1)
+            if (from_idx + 1 == growth.size()) growth.pop_back();
+            else growth.erase(growth.begin() + from_idx);
             continue;
         }
 
-        // Выбираем случайного соседа и добавляем в фигуру
-        std::uniform_int_distribution<> n_dist(0, valid_neighbors.size()-1);
-        int next = valid_neighbors[n_dist(rng)];
+        // Выбираем случайного соседа и добавляем в фигуру (в конец ее списка клеток)
+        std::uniform_int_distribution<> n_dist(0, neighbors.size()-1);
+        int next = neighbors[n_dist(area.rng)];
         
-        current_shape.push_back(next);
-        in_shape[next] = true;
+        part.label[next] = shape;
+        part.next_cell[part.tail[shape]] = next;
+        part.tail[shape] = next;
+        part.area[shape]++;
         growth.push_back(next);
-        is_free[next] = 0; 
     }
     
-    return current_shape;
+    return true;
 }
 
 // 2. Слияние мелких остатков с соседями (Упрощенная версия: Поглощение)
-std::vector<PuzzleGenerator::TempShape> PuzzleGenerator::merge_small_shapes(const std::vector<TempShape>& input_shapes, std::shared_ptr<Grid> grid) {
-    std::vector<TempShape> shapes = input_shapes;
-    
-    // Карта: ID клетки -> Индекс фигуры в векторе shapes
-    std::vector<int> cell_to_shape_idx(grid->size(), -1);
+void PuzzleGenerator::merge_small_shapes(Partition& part, const Grid& grid, GrowArea& area) {
+    std::vector<int>& neighbor_roots = area.neighbor_roots;
     
-    // Инициализация карты
-    for(size_t i=0; i<shapes.size(); ++i) {
-        for(int cid : shapes[i].cells) {
-            cell_to_shape_idx[cid] = (int)i;
-        }
-    }
-    
-    // Проходим по всем фигурам
-    for(size_t i=0; i<shapes.size(); ++i) {
-        // Если фигура уже удалена (пустая) или достаточно большая - пропускаем
-        if (shapes[i].cells.empty() || shapes[i].area >= config.min_shape_size) {
-            continue;
-        }
-        
-        // Фигура маленькая - нужно слить с соседом
-        // Ищем соседей
-        std::vector<int> neighbor_indices;
-        
-        for(int cid : shapes[i].cells) {
-            const auto& node = grid->get_node(cid);
-            for(int n_cid : node.get_all_neighbors()) {
-                if (n_cid != -1) {
-                    int n_idx = cell_to_shape_idx[n_cid];
-                    // Если сосед существует, не является нами самими и не удален
-                    if (n_idx != -1 && n_idx != (int)i && !shapes[n_idx].cells.empty()) {
-                        neighbor_indices.push_back(n_idx);
-                    }
+    // Проходим по всем фигурам area (номер фигуры - ее начальная клетка)
+    for(int y = area.y0; y < area.y1; ++y) {
+        for(int x = area.x0; x < area.x1; ++x) {
+            int i = grid.get_node_id_at(x, y);
+            // Если фигура уже слита с другой или достаточно большая - пропускаем
+            if (part.parent[i] != i || part.area[i] >= config.min_shape_size) {
+                continue;
+            }
+            
+            // Фигура маленькая - нужно слить с соседом. Ищем соседей по клеткам фигуры
+            // (вместе с уже поглощенными ею)
+            neighbor_roots.clear();
+            for(int cid = i; cid != -1; cid = part.next_cell[cid]) {
+                for(int n_cid : grid.get_node(cid).get_all_neighbors()) {
+                    if (n_cid == -1 || !area.contains(grid.get_node(n_cid).get_data()) || part.label[n_cid] == -1) continue;
+                    int root = part.find(part.label[n_cid]);
+                    if (root != i) neighbor_roots.push_back(root);
                 }
             }
-        }
-        
-        // Удаляем дубликаты соседей
-        std::sort(neighbor_indices.begin(), neighbor_indices.end());
-        neighbor_indices.erase(std::unique(neighbor_indices.begin(), neighbor_indices.end()), neighbor_indices.end());
-        
-        if (!neighbor_indices.empty()) {
-            // Выбираем случайного соседа для слияния
-            std::uniform_int_distribution<> dist(0, neighbor_indices.size() - 1);
-            int target_idx = neighbor_indices[dist(rng)];
             
-            // Сливаем i -> target_idx
-            auto& src = shapes[i];
-            auto& dst = shapes[target_idx];
+            // Удаляем дубликаты соседей
+            std::sort(neighbor_roots.begin(), neighbor_roots.end());
+            neighbor_roots.erase(std::unique(neighbor_roots.begin(), neighbor_roots.end()), neighbor_roots.end());
             
-            // Переносим клетки
-            for(int cid : src.cells) {
-                dst.cells.push_back(cid);
-                cell_to_shape_idx[cid] = target_idx; // Обновляем карту
+            if (!neighbor_roots.empty()) {
+                // Выбираем случайного соседа для слияния
+                std::uniform_int_distribution<> dist(0, neighbor_roots.size() - 1);
+                part.unite(i, neighbor_roots[dist(area.rng)]);
             }
-            dst.area += src.area;
-            
-            // Очищаем источник
-            src.cells.clear();
-            src.area = 0;
         }
     }
-    
-    // Собираем только выжившие фигуры
-    std::vector<TempShape> final_shapes;
-    for(const auto& s : shapes) {
-        if (!s.cells.empty()) {
-            final_shapes.push_back(s);
+}
+
+void PuzzleGenerator::reconcile_seams(const Grid& grid, Partition& part, int tile, int tiles_x, int tiles_y) {
+    // Полоса - по half клеток с каждой стороны шва; снимаются целиком все фигуры,
+    // у которых есть клетка в полосе, поэтому заново разбивается и их продолжение вглубь тайлов
+    int half = std::max(1, config.max_shape_size / 2);
+    int seams = (tiles_x - 1) + (tiles_y - 1);
+
+    for(int s = 0; s < seams; ++s) {
+        bool vertical = s < tiles_x - 1;
+        int line = vertical ? (s + 1) * tile : (s - (tiles_x - 1) + 1) * tile;
+        int from = std::max(0, line - half);
+        int to = std::min(vertical ? config.width : config.height, line + half);
+
+        // Прямоугольник, в котором оказались снятые клетки: в нем и идет новое разбиение
+        GrowArea area;
+        area.x0 = config.width;
+        area.y0 = config.height;
+        auto release = [&](int root) {
+            for(int cid = root; cid != -1;) {
+                const auto& cell = grid.get_node(cid).get_data();
+                area.x0 = std::min(area.x0, cell.x);
+                area.y0 = std::min(area.y0, cell.y);
+                area.x1 = std::max(area.x1, cell.x + 1);
+                area.y1 = std::max(area.y1, cell.y + 1);
+                int next = part.next_cell[cid];
+                part.label[cid] = -1;
+                part.next_cell[cid] = -1;
+                part.parent[cid] = -1;
+                part.area[cid] = 0;
+                cid = next;
+            }
+        };
+        for(int a = from; a < to; ++a) {
+            int length = vertical ? config.height : config.width;
+            for(int b = 0; b < length; ++b) {
+                int cid = vertical ? grid.get_node_id_at(a, b) : grid.get_node_id_at(b, a);
+                if (part.label[cid] != -1) release(part.find(part.label[cid]));
+            }
         }
+        if (area.x1 <= area.x0) continue;
+
+        std::seed_seq seq{(uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)(tiles_x * tiles_y + s)};
+        area.rng.seed(seq);
+        partition_area(grid, part, area);
     }
-    
-    return final_shapes;
+}
+
+// Преобразование фигур-корней в объекты Figure сохраняя топологию сетки.
+// Клетки обходятся по порядку номеров (подряд по памяти сетки), а не по спискам фигур:
+// фигура заводится при первой встрече ее клетки, узлы добавляются в порядке обхода
+std::vector<PuzzleGenerator::TempShape> PuzzleGenerator::extract_figures(Partition& part, const Grid& grid, Assignment& assignment) {
+    std::vector<TempShape> shapes;
+    std::vector<int> shape_index(part.label.size(), -1); // корень -> индекс в shapes
+
+    for(size_t cid = 0; cid < part.label.size(); ++cid) {
+        if (part.label[cid] == -1) continue;
+        // Метка клетки - сразу корень, во втором проходе find не нужен
+        int root = part.find(part.label[cid]);
+        part.label[cid] = root;
+        if (shape_index[root] == -1) {
+            shape_index[root] = (int)shapes.size();
+            auto fig = std::make_shared<Figure>("S_" + std::to_string(piece_counter), grid.get_max_ports());
+            fig->reserve(part.area[root]);
+            shapes.push_back({fig, piece_counter, part.area[root]});
+            piece_counter++;
+        }
+        const TempShape& shape = shapes[shape_index[root]];
+        // Номер узла в фигуре (понижение номеров/сжатие координат)
+        local_id[cid] = shape.graph->add_node();
+        // Записываем ID фигуры в решение (для валидации решения)
+        assignment.figure_id[cid] = shape.id;
+    }
+
+    for(size_t cid = 0; cid < part.label.size(); ++cid) {
+        if (part.label[cid] == -1) continue;
+        const auto& g_node = grid.get_node(cid);
+        Figure& fig = *shapes[shape_index[part.label[cid]]].graph;
+        for (int p=0; p < grid.get_max_ports(); ++p) {
+            int neighbor_gid = g_node.get_neighbor(p);
+            if (neighbor_gid != -1 && part.label[neighbor_gid] == part.label[cid]) {
+                fig.add_directed_edge(local_id[cid], local_id[neighbor_gid], p); // мы перебираем ВСЕ ноды, поэтому можем не искать обратный порт
+            }
+        }
+    }
+    return shapes;
 }
 
 // 3. Формирование бандлов и раскраска
-std::vector<Bundle> PuzzleGenerator::create_bundles(std::vector<TempShape>& shapes, std::shared_ptr<Grid> grid) {
+std::vector<Bundle> PuzzleGenerator::create_bundles(std::vector<TempShape>& shapes, Assignment& assignment) {
     std::shuffle(shapes.begin(), shapes.end(), rng);
     
     std::vector<Bundle> bundles;
+    std::vector<int> figure_bundle(shapes.size(), -1); // id фигуры -> бандл
     size_t idx = 0;
     int bundle_counter = 0;
     
@@ -288,11 +350,7 @@ std::vector<Bundle> PuzzleGenerator::create_bundles(std::vector<TempShape>& shap
              group_shapes.push_back(item.graph);
              current_bundle_area += item.area;
              
-             // Заполняем ID бандла в сетке
-             for(int nid : item.cells) {
-                 grid->get_node(nid).get_data().bundle_id = bundle_counter;
-             }
-             
+             figure_bundle[item.id] = bundle_counter;
              idx++;
         }
 
@@ -301,6 +359,12 @@ std::vector<Bundle> PuzzleGenerator::create_bundles(std::vector<TempShape>& shap
         bundles.emplace_back(bundle_counter, group_shapes, Color{255, 255, 255});
         bundle_counter++;
     }
+
+    // Заполняем ID бандла в решении одним проходом по клеткам
+    for(size_t nid = 0; nid < assignment.size(); ++nid) {
+        int fig = assignment.figure_id[nid];
+        if (fig != -1) assignment.bundle_id[nid] = figure_bundle[fig];
+    }
     
     // Раскраска (Heatmap based on area)
     size_t min_area = 1e9, max_area = 0;
@@ -324,67 +388,72 @@ std::vector<Bundle> PuzzleGenerator::create_bundles(std::vector<TempShape>& shap
 // Основной метод генерации задачи
 Puzzle PuzzleGenerator::generate() {
     piece_counter = 0;
-    std::shared_ptr<Grid> out_grid;
 
     // 1. Создаем пустую сетку нужного типа
-    if (config.grid_type == GridType::HEXAGON) {
-        out_grid = create_hex_grid();
-    } else if (config.grid_type == GridType::TRIANGLE) {
-        out_grid = create_triangle_grid();
-    } else {
-        out_grid = create_square_grid();
-    }
-
-    // Оптимизация: Используем вектор для пула свободных узлов (для рандома)
-    std::vector<int> available_nodes_pool;
-    available_nodes_pool.reserve(out_grid->size());
-    std::vector<char> node_is_free(out_grid->size(), 1); // 1 = свободно, 0 = занято
+    std::shared_ptr<Grid> out_grid = create_grid(config.grid_type, config.width, config.height, config.node_order);
 
-    for(size_t i=0; i<out_grid->size(); ++i) {
-        available_nodes_pool.push_back(i);
-    }
+    // Разбиение на фигуры; все клетки свободны
+    size_t n = out_grid->size();
+    Partition part;
+    part.label.assign(n, -1);
+    part.next_cell.assign(n, -1);
+    part.tail.resize(n);
+    part.area.resize(n);
+    part.parent.assign(n, -1);
+    local_id.assign(n, -1);
 
-    std::vector<TempShape> shapes_data;
-    
-    // 2. Выращивание фигур (Partitioning)
-    std::uniform_int_distribution<> size_dist(config.min_shape_size, config.max_shape_size);
+    // 2. Выращивание фигур (Partitioning). Сетка режется на тайлы (tile_size = 0 - тайл один,
+    // вся сетка), и потоки растят фигуры каждый в своем тайле. Разбиение на тайлы от числа
+    // потоков не зависит, у тайла и у шва свой поток случайных чисел из seed, поэтому
+    // результат при заданном seed одинаков при любом threads
+    int tile = config.tile_size > 0 ? std::max(config.tile_size, config.max_shape_size)
+                                    : std::max(config.width, config.height);
+    int tiles_x = (config.width + tile - 1) / tile;
+    int tiles_y = (config.height + tile - 1) / tile;
+    auto make_area = [&](int t) {
+        GrowArea area;
+        area.x0 = (t % tiles_x) * tile;
+        area.y0 = (t / tiles_x) * tile;
+        area.x1 = std::min(config.width, area.x0 + tile);
+        area.y1 = std::min(config.height, area.y0 + tile);
+        std::seed_seq seq{(uint32_t)seed, (uint32_t)(seed >> 32), (uint32_t)t};
+        area.rng.seed(seq);
+        return area;
+    };
 
-    while(!available_nodes_pool.empty()) {
-        // Быстрый выбор случайного:
-        std::uniform_int_distribution<> dis(0, available_nodes_pool.size()-1);
-        int rand_idx = dis(rng);
-        int start = available_nodes_pool[rand_idx];
-        
-        // Swap-and-pop
-        available_nodes_pool[rand_idx] = available_nodes_pool.back();
-        available_nodes_pool.pop_back();
-
-        // Попытка вырастить фигуру
-        int target_size = size_dist(rng);
-        
-        if (auto new_cells = grow_region(start, target_size, out_grid, node_is_free)) {
-            shapes_data.push_back({nullptr, *new_cells, (int)new_cells->size()});
+    if (tiles_x * tiles_y > 1) {
+        WorkStealingPool workers(config.threads);
+        TaskGroup group(workers);
+        for(int t = 0; t < tiles_x * tiles_y; ++t) {
+            group.inject([&, t]() {
+                GrowArea area = make_area(t);
+                partition_area(*out_grid, part, area);
+            });
         }
-    }
+        group.wait();
 
-    // 2.5 Слияние мелких остатков (Merge)
-    // ТЕПЕРЬ ФУНКЦИЯ ВОЗВРАЩАЕТ НОВЫЙ СПИСОК ФИГУР
-    shapes_data = merge_small_shapes(shapes_data, out_grid);
-    
-    // Создаем финальные объекты Figure (Graph objects)
-    for(auto& shape : shapes_data) {
-        auto fig = subset_to_figure("S_" + std::to_string(piece_counter), shape.cells, out_grid);
-        shape.graph = fig;
-        
-        // Записываем ID фигуры в сетку (для валидации решения)
-        for(int cid : shape.cells) {
-            out_grid->get_node(cid).get_data().figure_id = piece_counter;
-        }
-        piece_counter++;
+        // 2.5 Швы: фигуры не пересекают границы тайлов, и без доработки на поле видны
+        // прямые разрезы. Полосы вдоль швов разбиваются заново, затем мелкие остатки
+        // сливаются с соседями по всей сетке (крупные фигуры пропускаются сразу)
+        reconcile_seams(*out_grid, part, tile, tiles_x, tiles_y);
+        GrowArea whole;
+        whole.x1 = config.width;
+        whole.y1 = config.height;
+        whole.rng.seed(rng());
+        merge_small_shapes(part, *out_grid, whole);
+    } else {
+        GrowArea whole = make_area(0);
+        partition_area(*out_grid, part, whole);
     }
+    
+    // Создаем финальные объекты Figure (Graph objects) и figure_id клеток
+    Assignment assignment(out_grid->size());
+    std::vector<TempShape> shapes_data = extract_figures(part, *out_grid, assignment);
 
     // 3. Группировка фигур в Бандлы (Bundles)
-    std::vector<Bundle> bundles = create_bundles(shapes_data, out_grid);
+    std::vector<Bundle> bundles = create_bundles(shapes_data, assignment);
     
-    return Puzzle(out_grid, bundles, "Generated");
+    Puzzle puzzle(out_grid, bundles, "Generated");
+    puzzle.set_assignment(std::move(assignment));
+    return puzzle;
 }
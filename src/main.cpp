@@ -9,6 +9,8 @@
 
 #include "generators.h"
 #include "solvers.h"
+#include "server.h"
+#include "corpus.h"
 #include "utils/ConfigLoader.hpp"
 #include "utils/Serializer.hpp"
 #include "utils/Timer.hpp"
@@ -18,8 +20,23 @@ struct Args {
     std::string config = "";
     std::string input = "";
     std::string output = "";
-    std::string algo = "grasp";
+    std::string algo = "";           // По умолчанию grasp, с --warm-start - lns
+    std::string warm_start = "";     // Прежнее решение, от которого начинается поиск
+    std::string socket = "";         // Unix-сокет демона (--mode serve); пусто - stdin/stdout
+    int max_concurrent = 1;          // Одновременных запросов демона
+    int cache_mb = 256;              // Бюджет кэша таблиц размещений, МБ
+    bool cache = false;              // solve: таблицы размещений только с --cache-mb или --cache-dir
+    std::string cache_dir = "";      // Каталог таблиц размещений между запусками; пусто - без диска
+    std::string format = "json";     // Формат файлов generate: json | compact
     double timeout = 0.0; // Таймаут в секундах
+    int threads = 1;      // Количество рабочих потоков солвера
+    std::string branching = "contact"; // Стратегия ветвления: contact | mcc
+    std::string enumeration = "full";  // Перебор якорей: full | frontier
+    std::string scoring = "contact";   // Оценка мест: contact | perimeter | border | holes | edges
+    bool parallel_bundles = false;     // Параллельный перебор ветвей крупных бандлов
+    int tile_size = 32;                // Размер тайла для --algo tiled
+    int beam_width = 8;                // Ширина луча для --algo beam
+    bool reactive = true;              // Реактивный выбор alpha и порядка бандлов в GRASP
     bool verbose = false;
 };
 
@@ -33,11 +50,33 @@ Args parse_args(int argc, char* argv[]) {
         else if(arg == "--output" && i+1 < argc) args.output = argv[++i];
         else if(arg == "--algo" && i+1 < argc) args.algo = argv[++i];
         else if((arg == "--timeout" || arg == "--time") && i+1 < argc) args.timeout = std::stod(argv[++i]);
+        else if(arg == "--threads" && i+1 < argc) args.threads = std::stoi(argv[++i]);
+        else if(arg == "--branching" && i+1 < argc) args.branching = argv[++i];
+        else if(arg == "--enumeration" && i+1 < argc) args.enumeration = argv[++i];
+        else if(arg == "--scoring" && i+1 < argc) args.scoring = argv[++i];
+        else if(arg == "--parallel-bundles") args.parallel_bundles = true;
+        else if(arg == "--tile-size" && i+1 < argc) args.tile_size = std::stoi(argv[++i]);
+        else if(arg == "--beam-width" && i+1 < argc) args.beam_width = std::stoi(argv[++i]);
+        else if(arg == "--no-reactive") args.reactive = false;
+        else if(arg == "--warm-start" && i+1 < argc) args.warm_start = argv[++i];
+        else if(arg == "--socket" && i+1 < argc) args.socket = argv[++i];
+        else if(arg == "--max-concurrent" && i+1 < argc) args.max_concurrent = std::stoi(argv[++i]);
+        else if(arg == "--cache-mb" && i+1 < argc) { args.cache_mb = std::stoi(argv[++i]); args.cache = true; }
+        else if(arg == "--cache-dir" && i+1 < argc) { args.cache_dir = argv[++i]; args.cache = true; }
+        else if(arg == "--format" && i+1 < argc) args.format = argv[++i];
         else if(arg == "--verbose" || arg == "-v") args.verbose = true;
     }
     return args;
 }
 
+ScoringPolicy parse_scoring(const std::string& name) {
+    if (name == "perimeter") return ScoringPolicy::PERIMETER;
+    if (name == "border") return ScoringPolicy::BORDER;
+    if (name == "holes") return ScoringPolicy::HOLES;
+    if (name == "edges") return ScoringPolicy::EDGES;
+    return ScoringPolicy::CONTACT;
+}
+
 int main(int argc, char* argv[]) {
     Args args = parse_args(argc, argv);
 
@@ -48,8 +87,10 @@ int main(int argc, char* argv[]) {
             args.output = argv[2];
         } else {
             std::cout << "Usage:\n"
-                  << "  Generate: ./solver_cli --mode generate --config <cfg> --output <path>\n"
-                  << "  Solve:    ./solver_cli --mode solve --input <json> --output <json> --algo <name> [--timeout <sec>]\n";
+                  << "  Generate: ./solver_cli --mode generate --config <cfg> --output <path> [--threads <n>] [--format json|compact]\n"
+                  << "  Corpus:   ./solver_cli --mode corpus --config <sweep> --output <dir> [--threads <n>]\n"
+                  << "  Solve:    ./solver_cli --mode solve --input <json> --output <json> --algo grasp|tiled|multilevel|lns|beam|portfolio [--timeout <sec>] [--threads <n>] [--branching contact|mcc] [--enumeration full|frontier] [--scoring contact|perimeter|border|holes|edges] [--parallel-bundles] [--tile-size <n>] [--beam-width <n>] [--no-reactive] [--warm-start <solution.json>] [--cache-mb <n>] [--cache-dir <dir>]\n"
+                  << "  Serve:    ./solver_cli --mode serve [--socket <path>] [--max-concurrent <n>] [--timeout <max sec>] [--cache-mb <n>] [--cache-dir <dir>] [--threads <n>]\n";
             return 1;
         }
     }
@@ -60,6 +101,7 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         GeneratorConfig config = ConfigLoader::load(args.config);
+        if (args.threads > 1) config.threads = args.threads; // параллельная генерация по тайлам
         PuzzleGenerator generator(config);
         
         // Генерируем полный пазл (решенный)
@@ -73,14 +115,18 @@ int main(int argc, char* argv[]) {
         } else {
             target_path += "_target.json";
         }
-        Serializer::save(solved_puzzle, target_path);
+        auto save = [&](const Puzzle& p, const std::string& path) {
+            if (args.format != "compact") Serializer::save(p, path);
+            else if (!Serializer::save_compact(p, path)) std::cerr << "Failed to open output file: " << path << std::endl;
+        };
+        save(solved_puzzle, target_path);
         std::cout << "Generated target solution: " << target_path << std::endl;
 
         // 2. Создаем "Задачу" (очищаем сетку)
         Puzzle task_puzzle = solved_puzzle.clone();
         task_puzzle.clear_grid();
         
-        Serializer::save(task_puzzle, args.output);
+        save(task_puzzle, args.output);
         std::cout << "Generated benchmark: " << args.output << std::endl;
     } 
     else if (args.mode == "solve") {
@@ -100,13 +146,44 @@ int main(int argc, char* argv[]) {
         SolverConfig cfg;
         cfg.max_time_seconds = args.timeout;
         cfg.verbose = args.verbose;
-
-        // Only GRASP is supported
-        auto solver = std::make_unique<GRASPSolver>(puzzle, cfg);
+        cfg.num_threads = args.threads;
+        if (args.branching == "mcc") cfg.branching = BranchingStrategy::MOST_CONSTRAINED_CELL;
+        if (args.enumeration == "frontier") cfg.enumeration = CandidateEnumeration::FRONTIER;
+        cfg.scoring = parse_scoring(args.scoring);
+        cfg.parallel_backtracking = args.parallel_bundles;
+        cfg.tile_size = args.tile_size;
+        cfg.beam_width = args.beam_width;
+        cfg.reactive = args.reactive;
+        if (args.algo.empty()) args.algo = args.warm_start.empty() ? "grasp" : "lns";
 
         Timer timer;
         timer.start();
-        auto result = solver->solve();
+        std::unique_ptr<Solver> solver = SolverRegistry::instance().create(args.algo, puzzle, cfg);
+        if (!solver) {
+            std::cerr << "Unknown algorithm: " << args.algo << ". Available:";
+            for (const auto& name : SolverRegistry::instance().names()) std::cerr << " " << name;
+            std::cerr << std::endl;
+            return 1;
+        }
+        if (!args.warm_start.empty()) {
+            if (!solver->supports_warm_start()) {
+                std::cerr << "Error: --warm-start is not supported by --algo " << args.algo
+                          << " (use lns or portfolio)." << std::endl;
+                return 1;
+            }
+            Puzzle prior = Serializer::load(args.warm_start);
+            if (!prior.get_grid() || prior.get_grid()->size() == 0) {
+                std::cerr << "Failed to load warm start: " << args.warm_start << std::endl;
+                return 1;
+            }
+            solver->set_warm_start(std::make_shared<Puzzle>(prior));
+        }
+        // Одиночному запуску таблицы окупаются не всегда (их построение - вложение каждой фигуры
+        // во все клетки), поэтому кэш подключается явно; демон держит его всегда
+        if (args.cache) {
+            solver->set_placement_cache(std::make_shared<PlacementCache>((size_t)args.cache_mb << 20, args.cache_dir));
+        }
+        SolverResult result = solver->solve();
         float score = result.score;
         double duration = timer.get_elapsed_sec() * 1000.0;
         
@@ -127,11 +204,39 @@ int main(int argc, char* argv[]) {
         std::cout << " Coverage  : " << coverage << "%" << std::endl;
         std::cout << "========================================" << std::endl;
         
-        // Сохраняем решенную сетку из солвера
-        // Создаем новый Puzzle с решенной сеткой и исходными бандлами
-        Puzzle solved_puzzle(solver->graph, puzzle.get_bundles(), "Solved");
+        // Сохраняем решение: та же задача (общие сетка и бандлы) с решением солвера
+        Puzzle solved_puzzle = puzzle.clone();
+        solved_puzzle.set_name("Solved");
+        solved_puzzle.set_assignment(std::move(result.assignment));
         Serializer::save(solved_puzzle, args.output);
     } 
+    else if (args.mode == "corpus") {
+        if (args.config.empty() || args.output.empty()) {
+            std::cerr << "Error: Missing --config or --output for corpus mode." << std::endl;
+            return 1;
+        }
+        CorpusOptions options;
+        options.sweep_path = args.config;
+        options.output_dir = args.output;
+        options.threads = args.threads;
+        return run_corpus(options);
+    }
+    else if (args.mode == "serve") {
+        ServerOptions options;
+        options.socket_path = args.socket;
+        options.max_concurrent = args.max_concurrent;
+        if (args.timeout > 0.0) options.max_time_seconds = args.timeout;
+        options.cache_mb = (size_t)args.cache_mb;
+        options.cache_dir = args.cache_dir;
+        options.defaults.num_threads = args.threads;
+        if (args.branching == "mcc") options.defaults.branching = BranchingStrategy::MOST_CONSTRAINED_CELL;
+        if (args.enumeration == "frontier") options.defaults.enumeration = CandidateEnumeration::FRONTIER;
+        options.defaults.scoring = parse_scoring(args.scoring);
+        options.defaults.tile_size = args.tile_size;
+        options.defaults.beam_width = args.beam_width;
+        options.defaults.reactive = args.reactive;
+        return run_server(options);
+    }
     else {
         std::cerr << "Unknown mode: " << args.mode << std::endl;
         return 1;
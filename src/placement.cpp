@@ -0,0 +1,305 @@
+#include "placement.hpp"
+#include <algorithm>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// FNV-1a по 64-битным словам
+static uint64_t mix(uint64_t h, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        h ^= (value >> (i * 8)) & 0xFF;
+        h *= 0x100000001B3ull;
+    }
+    return h;
+}
+
+uint64_t grid_topology_hash(const Grid& grid) {
+    uint64_t h = 0xCBF29CE484222325ull;
+    h = mix(h, (uint64_t)grid.get_width());
+    h = mix(h, (uint64_t)grid.get_height());
+    h = mix(h, (uint64_t)grid.get_type());
+    h = mix(h, (uint64_t)grid.size());
+    for (const auto& node : grid.get_nodes()) {
+        h = mix(h, (uint64_t)(uint32_t)node.get_data().x);
+        h = mix(h, (uint64_t)(uint32_t)node.get_data().y);
+        for (size_t p = 0; p < grid.get_max_ports(); ++p) {
+            h = mix(h, (uint64_t)(uint32_t)node.get_neighbor(p));
+        }
+    }
+    return h;
+}
+
+FigureKey canonical_figure_key(const Figure& figure, size_t grid_ports) {
+    size_t k = figure.size();
+    int ports = (int)grid_ports;
+    std::vector<int> best_code;
+    FigureKey key;
+
+    // Код при сдвиге s: порт p фигуры считается портом (p + s) % ports. Узлы нумеруются
+    // в порядке обхода в ширину от узла 0, для каждого узла по порядку новых портов
+    // записывается номер соседа или -1.
+    std::vector<int> order(k), number(k);
+    for (int s = 0; s < ports && k > 0; ++s) {
+        std::vector<int> code;
+        code.reserve(k * ports);
+        std::fill(number.begin(), number.end(), -1);
+        size_t count = 0;
+        order[count] = 0;
+        number[0] = (int)count++;
+        for (size_t head = 0; head < count; ++head) {
+            const auto& node = figure.get_node(order[head]);
+            for (int q = 0; q < ports; ++q) {
+                int p = ((q - s) % ports + ports) % ports;
+                int v = p < (int)figure.get_max_ports() ? node.get_neighbor(p) : -1;
+                if (v != -1 && number[v] == -1) {
+                    order[count] = v;
+                    number[v] = (int)count++;
+                }
+                code.push_back(v == -1 ? -1 : number[v]);
+            }
+        }
+        if (best_code.empty() || code < best_code) {
+            best_code = std::move(code);
+            key.shift = s;
+        }
+    }
+
+    uint64_t h = 0xCBF29CE484222325ull;
+    h = mix(h, (uint64_t)k);
+    h = mix(h, (uint64_t)ports);
+    for (int c : best_code) h = mix(h, (uint64_t)(uint32_t)c);
+    key.hash = h;
+    return key;
+}
+
+size_t footprint_halo(const Grid& grid, const int* fp, size_t k, int* out) {
+    const auto& nodes = grid.get_nodes();
+    size_t ports = grid.get_max_ports();
+    size_t len = 0;
+    for (size_t i = 0; i < k; ++i) {
+        const auto& node = nodes[fp[i]];
+        for (size_t p = 0; p < ports; ++p) {
+            int n = node.get_neighbor(p);
+            if (n == -1 || std::find(fp, fp + k, n) != fp + k) continue;
+            size_t j = 0;
+            while (j < len && out[j] / HALO_MULT != n) ++j;
+            if (j == len) out[len++] = n * HALO_MULT;
+            out[j]++;
+        }
+    }
+    return len;
+}
+
+PlacementTable::PlacementTable(const Grid& grid, const std::shared_ptr<Figure>& figure, const FigureKey& key,
+                               bool with_halos)
+    : figure_size(figure->size()), rotations(grid.get_max_ports()) {
+    size_t placements = grid.size() * rotations;
+    count = placements * std::max<size_t>(figure_size, 1);
+    // Обход всех мест: канонический поворот t - поворот t + shift исходной фигуры
+    auto for_each_placement = [&](auto&& visit) {
+        for (size_t anchor = 0; anchor < grid.size() && figure_size > 0; ++anchor) {
+            for (size_t t = 0; t < rotations; ++t) {
+                std::vector<int> fp = grid.get_embedding(figure, (int)anchor, (int)((t + key.shift) % rotations));
+                if (!fp.empty()) visit(anchor * rotations + t, fp);
+            }
+        }
+    };
+
+    // Шаг ореолов - самый длинный ореол. Он считается отдельным проходом до выделения памяти,
+    // чтобы таблица сразу строилась в итоговом размере, без буфера с запасом k * ports на место
+    if (with_halos) {
+        std::vector<int> scratch(figure_size * rotations);
+        size_t longest = 0;
+        for_each_placement([&](size_t, const std::vector<int>& fp) {
+            longest = std::max(longest, footprint_halo(grid, fp.data(), fp.size(), scratch.data()));
+        });
+        halo_stride = std::max<size_t>(longest, 1);
+    }
+
+    std::vector<int> fps(count + placements * halo_stride, -1);
+    for_each_placement([&](size_t slot, const std::vector<int>& fp) {
+        std::copy(fp.begin(), fp.end(), fps.begin() + slot * figure_size);
+        if (with_halos) footprint_halo(grid, fp.data(), fp.size(), &fps[count + slot * halo_stride]);
+    });
+    auto storage = std::make_shared<std::vector<int>>(std::move(fps));
+    cells = storage->data();
+    halos = with_halos ? cells + count : nullptr;
+    owner = storage;
+}
+
+// Заголовок файла таблицы; за ним - count элементов int32 следов и ореолы
+// (клетки * повороты * halo_stride элементов)
+struct PlacementFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t grid_hash;
+    uint64_t figure_hash;
+    uint64_t figure_size;
+    uint64_t rotations;
+    uint64_t count;
+    uint64_t halo_stride;
+};
+static const char PLACEMENT_MAGIC[4] = {'P', 'L', 'T', 'B'};
+
+PlacementCache::PlacementCache(size_t budget_bytes, std::string directory)
+    : budget(budget_bytes), directory(std::move(directory)) {
+    if (this->directory.empty()) return;
+    std::error_code ec;
+    std::filesystem::create_directories(this->directory, ec);
+    if (ec) this->directory.clear(); // без каталога кэш работает только в памяти
+}
+
+std::string PlacementCache::file_path(const Key& key) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "/%016llx-%016llx%s.v%u.plt", (unsigned long long)key.grid,
+                  (unsigned long long)key.figure, key.halos ? "-h" : "", PLACEMENT_FORMAT_VERSION);
+    return directory + name;
+}
+
+std::shared_ptr<const PlacementTable> PlacementCache::load_file(const Key& key, size_t figure_size,
+                                                                size_t rotations, size_t cells) const {
+    int fd = ::open(file_path(key).c_str(), O_RDONLY);
+    if (fd < 0) return nullptr;
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PlacementFileHeader)) {
+        ::close(fd);
+        return nullptr;
+    }
+    size_t length = (size_t)st.st_size;
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) return nullptr;
+    // Отображение живет, пока жива таблица
+    std::shared_ptr<const void> region(mapped, [length](const void* p) { ::munmap(const_cast<void*>(p), length); });
+
+    const auto* header = static_cast<const PlacementFileHeader*>(mapped);
+    if (std::memcmp(header->magic, PLACEMENT_MAGIC, 4) != 0 || header->version != PLACEMENT_FORMAT_VERSION ||
+        header->grid_hash != key.grid || header->figure_hash != key.figure ||
+        header->figure_size != figure_size || header->rotations != rotations || header->count != cells ||
+        (header->halo_stride != 0) != key.halos) {
+        return nullptr;
+    }
+    size_t placements = cells / std::max<size_t>(figure_size, 1);
+    if (length != sizeof(PlacementFileHeader) + (cells + placements * header->halo_stride) * sizeof(int32_t)) {
+        return nullptr;
+    }
+    const int* data = reinterpret_cast<const int*>(static_cast<const char*>(mapped) + sizeof(PlacementFileHeader));
+    return std::make_shared<const PlacementTable>(figure_size, rotations, cells, header->halo_stride, region, data);
+}
+
+void PlacementCache::store_file(const Key& key, const PlacementTable& table) const {
+    PlacementFileHeader header{};
+    std::memcpy(header.magic, PLACEMENT_MAGIC, 4);
+    header.version = PLACEMENT_FORMAT_VERSION;
+    header.grid_hash = key.grid;
+    header.figure_hash = key.figure;
+    header.figure_size = table.get_figure_size();
+    header.rotations = table.get_rotations();
+    header.count = table.size();
+    header.halo_stride = table.get_halo_stride();
+
+    // Запись во временный файл и rename: читатели видят либо старый файл, либо целый новый
+    std::string path = file_path(key);
+    std::string tmp = path + ".tmp" + std::to_string(::getpid()) + "-" +
+                      std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+    std::ofstream out(tmp, std::ios::binary);
+    if (!out.is_open()) return;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(table.data()), (std::streamsize)table.bytes());
+    out.close();
+    if (!out || std::rename(tmp.c_str(), path.c_str()) != 0) std::remove(tmp.c_str());
+}
+
+PlacementView PlacementCache::get(const Grid& grid, uint64_t grid_hash, const std::shared_ptr<Figure>& figure,
+                                  bool with_halos) {
+    FigureKey fk = canonical_figure_key(*figure, grid.get_max_ports());
+    Key key{grid_hash, fk.hash, with_halos};
+    size_t footprint_cells = grid.size() * grid.get_max_ports() * std::max<size_t>(figure->size(), 1);
+    // Длина ореола заранее неизвестна: место освобождается по оценке (ореол небольшой фигуры -
+    // около трех клеток на клетку фигуры), точный размер проверяется, когда таблица готова
+    size_t table_bytes = footprint_cells * (with_halos ? 4 : 1) * sizeof(int);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = items.find(key);
+        if (it != items.end()) {
+            hit_count++;
+            recent.splice(recent.begin(), recent, it->second.recent);
+            return {it->second.table, fk.shift};
+        }
+        miss_count++;
+        if (!make_room(table_bytes)) return {};
+    }
+
+    // Читаем с диска или строим без блокировки: параллельные запросы той же таблицы могут
+    // построить ее дважды, в кэш попадет первая
+    std::shared_ptr<const PlacementTable> table;
+    if (!directory.empty()) {
+        table = load_file(key, figure->size(), grid.get_max_ports(), footprint_cells);
+    }
+    bool from_disk = (bool)table;
+    if (!table) {
+        table = std::make_shared<const PlacementTable>(grid, figure, fk, with_halos);
+        if (!directory.empty()) store_file(key, *table);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = items.find(key);
+    if (it != items.end()) return {it->second.table, fk.shift};
+    if (!make_room(table->bytes())) return {}; // место заняли параллельные запросы
+    if (from_disk) disk_hit_count++;
+    recent.push_front(key);
+    items[key] = Item{table, recent.begin()};
+    used += table->bytes();
+    return {table, fk.shift};
+}
+
+// Вытесняет давно не использованные таблицы, которые сейчас никем не используются.
+// Таблицы, которые держат солверы, остаются: так в памяти не больше budget байт таблиц.
+bool PlacementCache::make_room(size_t bytes) {
+    if (bytes > budget) return false;
+    for (auto k = recent.rbegin(); used + bytes > budget && k != recent.rend();) {
+        auto old = items.find(*k);
+        if (old->second.table.use_count() > 1) {
+            ++k;
+            continue;
+        }
+        used -= old->second.table->bytes();
+        items.erase(old);
+        k = std::list<Key>::reverse_iterator(recent.erase(std::next(k).base()));
+    }
+    return used + bytes <= budget;
+}
+
+size_t PlacementCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return items.size();
+}
+
+size_t PlacementCache::bytes() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return used;
+}
+
+size_t PlacementCache::hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hit_count;
+}
+
+size_t PlacementCache::disk_hits() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return disk_hit_count;
+}
+
+size_t PlacementCache::misses() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return miss_count;
+}
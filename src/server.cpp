@@ -0,0 +1,447 @@
+#include "server.h"
+#include "utils/Serializer.hpp"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <list>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+namespace {
+
+std::string to_hex(uint64_t value) {
+    std::ostringstream out;
+    out << std::hex << value;
+    return out.str();
+}
+
+// Строки запросов из одного дескриптора, ответы в другой (запись под мьютексом:
+// ответы параллельных запросов не перемешиваются)
+class LineChannel {
+private:
+    int in_fd, out_fd;
+    std::string buffer;
+    std::mutex write_mutex;
+    std::condition_variable idle_cv;
+    int pending = 0; // запросов в очереди и в работе, ответ на которые еще не записан
+
+public:
+    LineChannel(int in_fd, int out_fd) : in_fd(in_fd), out_fd(out_fd) {}
+
+    void begin_request() {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        pending++;
+    }
+
+    // Ответ на запрос, отданный в работу через begin_request
+    void finish_request(const std::string& line) {
+        write_line(line);
+        {
+            std::lock_guard<std::mutex> lock(write_mutex);
+            pending--;
+        }
+        idle_cv.notify_all();
+    }
+
+    // Ждет ответов на все отданные в работу запросы: после этого канал можно закрыть
+    void wait_idle() {
+        std::unique_lock<std::mutex> lock(write_mutex);
+        idle_cv.wait(lock, [&]() { return pending == 0; });
+    }
+
+    bool read_line(std::string& line) {
+        while (true) {
+            size_t end = buffer.find('\n');
+            if (end != std::string::npos) {
+                line = buffer.substr(0, end);
+                buffer.erase(0, end + 1);
+                return true;
+            }
+            char chunk[65536];
+            ssize_t n = ::read(in_fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                if (buffer.empty()) return false;
+                line = std::move(buffer); // последняя строка без перевода строки
+                buffer.clear();
+                return true;
+            }
+            buffer.append(chunk, (size_t)n);
+        }
+    }
+
+    void write_line(const std::string& line) {
+        std::lock_guard<std::mutex> lock(write_mutex);
+        std::string data = line + "\n";
+        size_t done = 0;
+        while (done < data.size()) {
+            ssize_t n = ::write(out_fd, data.data() + done, data.size() - done);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return; // клиент ушел
+            done += (size_t)n;
+        }
+    }
+};
+
+class Server {
+public:
+    explicit Server(const ServerOptions& options)
+        : options(options), placements(std::make_shared<PlacementCache>(options.cache_mb << 20, options.cache_dir)) {
+        for (int i = 0; i < std::max(1, options.max_concurrent); ++i) {
+            workers.emplace_back([this]() { work(); });
+        }
+    }
+
+    ~Server() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cv.notify_all();
+        for (auto& t : workers) t.join();
+    }
+
+    // Обработка запросов канала до конца ввода или команды shutdown.
+    // Запросы решает общий пул из max_concurrent потоков; пока очередь полна,
+    // новые строки не читаются. Возвращается, когда на все запросы канала дан ответ.
+    void serve(LineChannel& channel) {
+        std::string line;
+        while (!shutting_down() && channel.read_line(line)) {
+            if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+            // Разбор и служебные команды: любая ошибка запроса - ответ с ok=false, а не падение
+            json request;
+            std::string cmd;
+            try {
+                request = json::parse(line);
+                if (!request.is_object()) throw std::runtime_error("request must be a JSON object");
+                cmd = request.value("cmd", "solve");
+                if (cmd == "stats") {
+                    channel.write_line(stats(request).dump());
+                    continue;
+                }
+                if (cmd == "shutdown") {
+                    shutdown.store(true);
+                    channel.write_line(json{{"id", request.value("id", json())}, {"ok", true}}.dump());
+                    break;
+                }
+                if (cmd != "solve") throw std::runtime_error("unknown cmd: " + cmd);
+            } catch (const std::exception& e) {
+                json response = {{"ok", false}, {"error", std::string("bad request: ") + e.what()}};
+                if (request.is_object() && request.contains("id")) response["id"] = request.at("id");
+                channel.write_line(response.dump());
+                continue;
+            }
+
+            channel.begin_request();
+            enqueue({std::move(request), &channel});
+        }
+        channel.wait_idle();
+    }
+
+    bool shutting_down() const { return shutdown.load(); }
+
+private:
+    ServerOptions options;
+    std::shared_ptr<PlacementCache> placements;
+    std::atomic<bool> shutdown{false};
+
+    // Разобранные сетки по хешу топологии и задачи из файлов по хешу содержимого,
+    // вытесняются в порядке давности использования
+    std::mutex cache_mutex;
+    std::map<uint64_t, std::shared_ptr<const Grid>> grids;
+    std::list<uint64_t> grid_order;
+    std::map<size_t, std::pair<Puzzle, uint64_t>> files; // задача и хеш ее сетки
+    std::list<size_t> file_order;
+
+    // Запрос на решение и канал, в который уйдет ответ
+    struct Job {
+        json request;
+        LineChannel* channel;
+    };
+
+    // Пул рабочих потоков с общей очередью (не длиннее числа потоков)
+    std::vector<std::thread> workers;
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;   // в очереди появилась работа или пул останавливается
+    std::condition_variable space_cv;   // в очереди освободилось место
+    std::deque<Job> queue;
+    bool stopping = false;
+
+    void enqueue(Job job) {
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            space_cv.wait(lock, [&]() { return queue.size() < workers.size(); });
+            queue.push_back(std::move(job));
+        }
+        queue_cv.notify_one();
+    }
+
+    void work() {
+        while (true) {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [&]() { return stopping || !queue.empty(); });
+                if (queue.empty()) return;
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            space_cv.notify_one();
+            job.channel->finish_request(handle(job.request).dump());
+        }
+    }
+
+    template <typename K>
+    static void touch(std::list<K>& order, const K& key) {
+        order.remove(key);
+        order.push_front(key);
+    }
+
+    // Возвращает сетку из кэша, если такая уже есть, иначе запоминает эту
+    std::shared_ptr<const Grid> intern_grid(std::shared_ptr<const Grid> grid, uint64_t hash) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = grids.find(hash);
+        if (it != grids.end()) {
+            touch(grid_order, hash);
+            return it->second;
+        }
+        grids[hash] = grid;
+        grid_order.push_front(hash);
+        while (grids.size() > options.max_grids) {
+            grids.erase(grid_order.back());
+            grid_order.pop_back();
+        }
+        return grid;
+    }
+
+    std::shared_ptr<const Grid> find_grid(uint64_t hash) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        auto it = grids.find(hash);
+        if (it == grids.end()) return nullptr;
+        touch(grid_order, hash);
+        return it->second;
+    }
+
+    // Задача запроса; бросает std::runtime_error, если ее не получить
+    Puzzle resolve_puzzle(const json& request, uint64_t& grid_hash) {
+        if (request.contains("grid_hash")) {
+            grid_hash = std::stoull(request.at("grid_hash").get<std::string>(), nullptr, 16);
+            auto grid = find_grid(grid_hash);
+            if (!grid) throw std::runtime_error("unknown grid_hash");
+            return Puzzle(grid, Serializer::bundles_from_json(request.value("bundles", json::array()),
+                                                              grid->get_max_ports()), "Request");
+        }
+
+        if (request.contains("input")) {
+            std::string path = request.at("input");
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open()) throw std::runtime_error("failed to open input: " + path);
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            size_t content_hash = std::hash<std::string>()(text);
+            {
+                std::lock_guard<std::mutex> lock(cache_mutex);
+                auto it = files.find(content_hash);
+                if (it != files.end()) {
+                    touch(file_order, content_hash);
+                    grid_hash = it->second.second;
+                    return it->second.first.clone();
+                }
+            }
+            Puzzle puzzle = intern(Serializer::from_json(json::parse(text), path), grid_hash);
+            std::lock_guard<std::mutex> lock(cache_mutex);
+            if (!files.emplace(content_hash, std::make_pair(puzzle, grid_hash)).second) return puzzle;
+            file_order.push_front(content_hash);
+            while (files.size() > options.max_grids) {
+                files.erase(file_order.back());
+                file_order.pop_back();
+            }
+            return puzzle;
+        }
+
+        if (request.contains("puzzle")) {
+            return intern(Serializer::from_json(request.at("puzzle"), "Request"), grid_hash);
+        }
+        throw std::runtime_error("request has no input, puzzle or grid_hash");
+    }
+
+    // Та же задача, но с сеткой из кэша (если такая топология уже загружалась)
+    Puzzle intern(const Puzzle& loaded, uint64_t& grid_hash) {
+        grid_hash = grid_topology_hash(*loaded.get_grid());
+        Puzzle puzzle(intern_grid(loaded.get_grid(), grid_hash), loaded.get_bundles(), loaded.get_name());
+        puzzle.set_assignment(loaded.get_assignment());
+        return puzzle;
+    }
+
+    json handle(const json& request) {
+        auto start = std::chrono::steady_clock::now();
+        json response = {{"id", request.value("id", json())}};
+        try {
+            uint64_t grid_hash = 0;
+            Puzzle puzzle = resolve_puzzle(request, grid_hash);
+
+            SolverConfig cfg = options.defaults;
+            cfg.verbose = false; // stdout - канал ответов
+            double time = request.value("time", 0.0);
+            cfg.max_time_seconds = (time > 0.0) ? std::min(time, options.max_time_seconds) : options.max_time_seconds;
+            // Запрос может попросить меньше потоков, но не больше, чем задано демону:
+            // иначе max_concurrent запросов заняли бы сколько угодно ядер
+            int max_threads = std::max(1, options.defaults.num_threads);
+            cfg.num_threads = std::min(max_threads, std::max(1, request.value("threads", max_threads)));
+
+            std::string algo = request.value("algo", "grasp");
+            auto solver = SolverRegistry::instance().create(algo, puzzle, cfg);
+            if (!solver) throw std::runtime_error("unknown algorithm: " + algo);
+            solver->set_placement_cache(placements);
+
+            // Сторож срока: солверы сами следят за временем, но по сроку запроса
+            // (с небольшим запасом) их останавливает флаг
+            std::atomic<bool> stop{false};
+            std::mutex done_mutex;
+            std::condition_variable done_cv;
+            bool done = false;
+            solver->set_stop_flag(&stop);
+            std::thread watchdog([&]() {
+                std::unique_lock<std::mutex> lock(done_mutex);
+                auto deadline = start + std::chrono::duration<double>(cfg.max_time_seconds * 1.1 + 0.05);
+                if (!done_cv.wait_until(lock, deadline, [&]() { return done; })) stop.store(true);
+            });
+            SolverResult result = solver->solve();
+            {
+                std::lock_guard<std::mutex> lock(done_mutex);
+                done = true;
+            }
+            done_cv.notify_one();
+            watchdog.join();
+
+            response["ok"] = true;
+            response["score"] = result.score;
+            response["cells"] = puzzle.get_grid()->size();
+            response["placed"] = result.placed_bundles;
+            response["grid_hash"] = to_hex(grid_hash);
+
+            if (request.contains("output")) {
+                Puzzle solved = puzzle.clone();
+                solved.set_name("Solved");
+                solved.set_assignment(std::move(result.assignment));
+                std::string path = request.at("output");
+                std::ofstream out(path);
+                if (!out.is_open()) throw std::runtime_error("failed to open output: " + path);
+                out << Serializer::to_json(solved).dump(4);
+            } else {
+                response["assignment"] = {{"bundle_id", result.assignment.bundle_id},
+                                          {"figure_id", result.assignment.figure_id}};
+            }
+        } catch (const std::exception& e) {
+            response["ok"] = false;
+            response["error"] = e.what();
+        }
+        std::chrono::duration<double, std::milli> ms = std::chrono::steady_clock::now() - start;
+        response["time_ms"] = ms.count();
+        return response;
+    }
+
+    json stats(const json& request) {
+        std::lock_guard<std::mutex> lock(cache_mutex);
+        return {{"id", request.value("id", json())}, {"ok", true},
+                {"grids", grids.size()}, {"files", files.size()},
+                {"placement_tables", placements->size()}, {"placement_bytes", placements->bytes()},
+                {"placement_hits", placements->hits()}, {"placement_misses", placements->misses()},
+                {"placement_disk_hits", placements->disk_hits()}};
+    }
+};
+
+} // namespace
+
+int run_server(const ServerOptions& options) {
+    Server server(options);
+
+    if (options.socket_path.empty()) {
+        LineChannel channel(0, 1);
+        server.serve(channel);
+        return 0;
+    }
+
+    int listen_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        std::cerr << "socket: " << std::strerror(errno) << std::endl;
+        return 1;
+    }
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    if (options.socket_path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Socket path too long: " << options.socket_path << std::endl;
+        ::close(listen_fd);
+        return 1;
+    }
+    std::strcpy(addr.sun_path, options.socket_path.c_str());
+    ::unlink(options.socket_path.c_str());
+    if (::bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(listen_fd, 16) < 0) {
+        std::cerr << "bind/listen " << options.socket_path << ": " << std::strerror(errno) << std::endl;
+        ::close(listen_fd);
+        return 1;
+    }
+    std::cerr << "Listening on " << options.socket_path << std::endl;
+
+    // Соединение - свой поток со своим каналом; accept с таймаутом, чтобы заметить shutdown.
+    // Поток закрывает дескриптор под мьютексом и помечает соединение закрытым, а цикл
+    // accept присоединяет такие потоки: номер закрытого дескриптора может достаться новому
+    // соединению, поэтому shutdown ниже трогает только открытые.
+    struct Connection {
+        int fd;
+        bool open = true;
+        std::thread thread;
+    };
+    std::list<Connection> connections;
+    std::mutex connections_mutex;
+    auto reap = [&]() {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (it->open) {
+                ++it;
+                continue;
+            }
+            it->thread.join();
+            it = connections.erase(it);
+        }
+    };
+    while (!server.shutting_down()) {
+        reap();
+        pollfd pfd{listen_fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 200) <= 0) continue;
+        int fd = ::accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        connections.push_back(Connection{fd, true, std::thread()});
+        Connection& connection = connections.back();
+        connection.thread = std::thread([&server, &connection, &connections_mutex]() {
+            LineChannel channel(connection.fd, connection.fd);
+            server.serve(channel);
+            std::lock_guard<std::mutex> lock(connections_mutex);
+            ::close(connection.fd);
+            connection.open = false;
+        });
+    }
+    // Новые запросы больше не читаются, начатые дорешиваются и получают ответы
+    {
+        std::lock_guard<std::mutex> lock(connections_mutex);
+        for (auto& connection : connections) {
+            if (connection.open) ::shutdown(connection.fd, SHUT_RD);
+        }
+    }
+    for (auto& connection : connections) connection.thread.join();
+    ::close(listen_fd);
+    ::unlink(options.socket_path.c_str());
+    return 0;
+}
@@ -0,0 +1,214 @@
+#include "solvers.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <unordered_set>
+#include <chrono>
+
+
+// Число сторон фигуры, прилегающих к занятым клеткам или к краю поля
+int BeamSolver::count_contacts(const std::vector<int>& footprint, const CowBitset& occupied,
+                               const std::vector<char>& local) const {
+    int contacts = 0;
+    for (int nid : footprint) {
+        const Node<GridCellData>& node = graph->get_node(nid);
+        for (size_t p = 0; p < graph->get_max_ports(); ++p) {
+            int neighbor_id = node.get_neighbor(p);
+            if (neighbor_id == -1 || occupied.test(neighbor_id) || local[neighbor_id]) {
+                contacts++;
+            }
+        }
+    }
+    return contacts;
+}
+
+bool BeamSolver::expand(const Bundle& bundle, const BeamEntry& entry, size_t shape_idx,
+                        std::vector<char>& local, BundlePlacement& current,
+                        std::vector<BundlePlacement>& out, int limit) const {
+    const auto& shapes = bundle.get_shapes();
+    if (shape_idx >= shapes.size()) {
+        out.push_back(current);
+        return true;
+    }
+
+    auto is_free = [&](int nid) { return !entry.occupied.test(nid) && !local[nid]; };
+
+    // Якоря - фронт (свободные клетки у занятых или у края); если с фронта фигура
+    // не ставится никуда, перебираем все свободные клетки
+    const std::shared_ptr<Figure>& shape = shapes[shape_idx];
+    std::vector<std::pair<int, std::vector<int>>> candidates;
+    auto collect_at = [&](int nid) {
+        for (int rot = 0; rot < (int)graph->get_max_ports(); ++rot) {
+            std::vector<int> fp = graph->get_embedding(shape, nid, rot);
+            if (fp.empty()) continue;
+            if (!std::all_of(fp.begin(), fp.end(), is_free)) continue;
+            candidates.push_back({count_contacts(fp, entry.occupied, local), std::move(fp)});
+        }
+    };
+    for (const auto& node : graph->get_nodes()) {
+        int nid = node.get_id();
+        if (!is_free(nid)) continue;
+        bool on_frontier = false;
+        for (size_t p = 0; p < graph->get_max_ports() && !on_frontier; ++p) {
+            int n = node.get_neighbor(p);
+            on_frontier = (n == -1 || !is_free(n));
+        }
+        if (on_frontier) collect_at(nid);
+    }
+    if (candidates.empty()) {
+        for (const auto& node : graph->get_nodes()) {
+            if (is_free(node.get_id())) collect_at(node.get_id());
+        }
+    }
+
+    std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+        return a.first > b.first;
+    });
+
+    // Первая фигура задает разнообразие вариантов бандла, остальные ставятся
+    // жадно с неглубоким возвратом: достаточно одного удачного завершения
+    int tries = (shape_idx == 0) ? limit : 2;
+    bool added = false;
+    for (int i = 0; i < (int)candidates.size() && i < tries && (int)out.size() < limit; ++i) {
+        const auto& [contacts, fp] = candidates[i];
+        for (int f : fp) local[f] = 1;
+        current.footprints.push_back(fp);
+        current.contact += contacts;
+
+        bool ok = expand(bundle, entry, shape_idx + 1, local, current, out, limit);
+
+        current.contact -= contacts;
+        current.footprints.pop_back();
+        for (int f : fp) local[f] = 0;
+
+        added = added || ok;
+        if (ok && shape_idx > 0) break;
+    }
+    return added;
+}
+
+SolverResult BeamSolver::solve() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - start_time;
+        return d.count();
+    };
+    bool use_timer = (config.max_time_seconds > 0.001);
+    size_t n = graph->size();
+
+    // Порядок бандлов - как в GRASP: сначала большие и сложные
+    std::vector<int> order(bundles.size());
+    for (size_t i = 0; i < bundles.size(); ++i) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (bundles[a].get_total_area() != bundles[b].get_total_area()) {
+            return bundles[a].get_total_area() > bundles[b].get_total_area();
+        }
+        return bundles[a].get_shapes().size() > bundles[b].get_shapes().size();
+    });
+
+    std::vector<BeamEntry> beam(1);
+    beam[0].occupied = CowBitset(n);
+    std::vector<char> local(n, 0);
+    bool narrowed = false;
+
+    if (config.verbose) {
+        std::cout << "Beam: ширина " << config.beam_width << ", ветвление " << config.beam_branching << std::endl;
+    }
+
+    for (int bi : order) {
+        const Bundle& bundle = bundles[bi];
+        size_t area = bundle.get_total_area();
+
+        // Время вышло или остановка извне: оставшиеся бандлы достраиваются жадно по лучшей записи
+        int width = std::max(1, config.beam_width);
+        int branching = std::max(1, config.beam_branching);
+        if (stop_requested() || (use_timer && elapsed() > config.max_time_seconds)) {
+            if (!narrowed && config.verbose) {
+                std::cout << "Beam: время вышло, дальше ширина 1" << std::endl;
+            }
+            narrowed = true;
+            beam.resize(1);
+            width = 1;
+            branching = 1;
+        }
+
+        // Потомки хранятся лениво (родитель + номер размещения): маска копируется
+        // только у тех, кто попадет в следующий луч
+        struct Child {
+            size_t parent;
+            int placement; // -1 - бандл пропущен
+            size_t area;
+            long long contact;
+            uint64_t hash;
+        };
+        std::vector<std::vector<BundlePlacement>> placements(beam.size());
+        std::vector<Child> children;
+        for (size_t e = 0; e < beam.size(); ++e) {
+            const BeamEntry& entry = beam[e];
+            children.push_back({e, -1, entry.area, entry.contact, entry.hash});
+            if (entry.area + area > n) continue;
+
+            BundlePlacement current;
+            expand(bundle, entry, 0, local, current, placements[e], branching);
+            for (size_t k = 0; k < placements[e].size(); ++k) {
+                const BundlePlacement& pl = placements[e][k];
+                uint64_t hash = entry.hash;
+                for (const auto& fp : pl.footprints) hash ^= zobrist.of(fp);
+                children.push_back({e, (int)k, entry.area + area, entry.contact + pl.contact, hash});
+            }
+        }
+
+        std::stable_sort(children.begin(), children.end(), [](const Child& a, const Child& b) {
+            if (a.area != b.area) return a.area > b.area;
+            return a.contact > b.contact;
+        });
+
+        // Одинаковая занятость, полученная разными путями, в луч попадает один раз
+        std::vector<BeamEntry> next;
+        std::unordered_set<uint64_t> seen;
+        for (const Child& child : children) {
+            if ((int)next.size() >= width) break;
+            if (!seen.insert(child.hash).second) continue;
+
+            BeamEntry entry = beam[child.parent]; // маска и история пока общие с родителем
+            if (child.placement >= 0) {
+                const BundlePlacement& pl = placements[child.parent][child.placement];
+                for (const auto& fp : pl.footprints) entry.occupied.set_all(fp);
+                auto trail = std::make_shared<Trail>();
+                trail->parent = entry.trail;
+                trail->bundle_id = bundle.get_id();
+                trail->footprints = pl.footprints;
+                entry.trail = trail;
+                entry.area = child.area;
+                entry.contact = child.contact;
+                entry.hash = child.hash;
+            }
+            next.push_back(std::move(entry));
+        }
+        beam = std::move(next);
+    }
+
+    // Лучшая запись - первая (луч упорядочен по площади). Разворачиваем историю в решение.
+    const BeamEntry& best = beam[0];
+    placed_bundles.clear();
+    Assignment assignment(n);
+    int fig_uid_counter = 0;
+    for (const Trail* t = best.trail.get(); t; t = t->parent.get()) {
+        placed_bundles.push_back(t->bundle_id);
+        for (const auto& fp : t->footprints) {
+            for (int f_id : fp) {
+                assignment.bundle_id[f_id] = t->bundle_id;
+                assignment.figure_id[f_id] = fig_uid_counter;
+            }
+            fig_uid_counter++;
+        }
+    }
+    std::reverse(placed_bundles.begin(), placed_bundles.end());
+
+    if (config.verbose) {
+        std::cout << "Beam: занято " << best.area << " / " << n
+                  << ", время: " << elapsed() << " сек." << std::endl;
+    }
+
+    return { (float)best.area, placed_bundles, std::move(assignment) };
+}
@@ -1,4 +1,7 @@
 #include "solvers.h"
+#include "utils/RclReservoir.hpp"
+#include "utils/SubsetSum.hpp"
+#include "utils/ScoringPolicies.hpp"
 #include <iostream>
 #include <algorithm>
 #include <vector>
@@ -6,164 +9,838 @@
 #include <set>
 #include <random>
 #include <chrono>
+#include <mutex>
+#include <cmath>
+#include <unordered_map>
+#include <type_traits>
 
 
-// Функция оценки качества размещения, чем больше соседей тем лучш
-int GRASPSolver::calculate_placement_score(const std::vector<int>& footprint, const std::vector<char>& occupied_mask) {
-    int neighbors = 0;
-    // Проходим по всем клеткам, которые займет фигура
-    for (int nid : footprint) {
-        const Node<GridCellData>& node = graph->get_node(nid);
-        // Смотрим соседей этой клетки
-        for(int neighbor_id : node.get_all_neighbors()) {
-            if (neighbor_id != -1) {
-                // Если сосед занят - это хорошо (фигуры прилипают друг к другу)
-                if (occupied_mask[neighbor_id]) {
-                    neighbors += 10;
+// Клетки на краю поля: хотя бы один порт ведет за пределы сетки
+void GRASPSolver::init_boundary_cells() {
+    boundary_cells.clear();
+    boundary_ports.assign(graph->size(), 0);
+    for(const auto& node : graph->get_nodes()) {
+        for(size_t p = 0; p < graph->get_max_ports(); ++p) {
+            if (node.get_neighbor(p) == -1) boundary_ports[node.get_id()]++;
+        }
+        if (boundary_ports[node.get_id()] > 0) boundary_cells.push_back(node.get_id());
+    }
+}
+
+GRASPSolver::BoardState GRASPSolver::make_empty_board() const {
+    BoardState board;
+    board.occupied.assign(graph->size(), 0);
+    board.contacts = boundary_ports;
+    if (config.enumeration == CandidateEnumeration::FRONTIER) {
+        board.frontier_pos.assign(graph->size(), -1);
+        board.visit.assign(graph->size(), 0);
+        board.frontier = boundary_cells;
+        for(size_t i = 0; i < boundary_cells.size(); ++i) {
+            board.frontier_pos[boundary_cells[i]] = (int)i;
+        }
+    }
+    return board;
+}
+
+void GRASPSolver::frontier_add(BoardState& board, int nid) {
+    if (board.frontier_pos[nid] != -1) return;
+    board.frontier_pos[nid] = (int)board.frontier.size();
+    board.frontier.push_back(nid);
+}
+
+void GRASPSolver::frontier_remove(BoardState& board, int nid) {
+    int pos = board.frontier_pos[nid];
+    if (pos == -1) return;
+    int last = board.frontier.back();
+    board.frontier[pos] = last;
+    board.frontier_pos[last] = pos;
+    board.frontier.pop_back();
+    board.frontier_pos[nid] = -1;
+}
+
+// Перебор всех допустимых мест (якорь + поворот) для фигуры на текущем поле.
+// Конкретизации для всех пар (эвристика, тип сетки) собраны в таблицу заранее:
+// выбор - один косвенный вызов на перебор, а не на каждое место.
+template <class Sink>
+int GRASPSolver::collect_candidates(const std::shared_ptr<Figure>& shape, const BoardState& board,
+                                    Sink&& sink, const std::vector<int>* anchors) {
+    using S = std::remove_reference_t<Sink>;
+    using Impl = int (GRASPSolver::*)(const std::shared_ptr<Figure>&, const BoardState&, S&,
+                                      const std::vector<int>*);
+    // [эвристика][тип сетки], в порядке ScoringPolicy и GridType
+    static const Impl table[5][3] = {
+        {&GRASPSolver::collect_candidates_impl<scoring::Contact, 4, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Contact, 6, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Contact, 3, S>},
+        {&GRASPSolver::collect_candidates_impl<scoring::Perimeter, 4, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Perimeter, 6, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Perimeter, 3, S>},
+        {&GRASPSolver::collect_candidates_impl<scoring::Border, 4, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Border, 6, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Border, 3, S>},
+        {&GRASPSolver::collect_candidates_impl<scoring::Holes, 4, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Holes, 6, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Holes, 3, S>},
+        {&GRASPSolver::collect_candidates_impl<scoring::Edges, 4, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Edges, 6, S>,
+         &GRASPSolver::collect_candidates_impl<scoring::Edges, 3, S>},
+    };
+    return (this->*table[(int)config.scoring][(int)graph->get_type()])(shape, board, sink, anchors);
+}
+
+// В режиме FRONTIER якорями служат только клетки фронта; полоса клеток за ним
+// перебирается лишь если с фронта не нашлось ни одного места.
+template <class Policy, int Ports, class Sink>
+int GRASPSolver::collect_candidates_impl(const std::shared_ptr<Figure>& shape, const BoardState& board,
+                                         Sink& sink, const std::vector<int>* anchors) {
+    // Таблица размещений фигуры, если есть (см. set_placement_cache)
+    static const PlacementView no_table;
+    auto table = placements.find(shape.get());
+    const PlacementView& view = table != placements.end() ? table->second : no_table;
+    std::vector<int> buffer, halo;
+
+    int found = 0;
+    if (anchors) {
+        for(int nid : *anchors) {
+            found += collect_candidates_at<Policy, Ports, Sink>(nid, shape, view, board, buffer, halo, sink);
+        }
+        return found;
+    }
+    if (config.enumeration == CandidateEnumeration::FRONTIER) {
+        for(int nid : board.frontier) {
+            found += collect_candidates_at<Policy, Ports, Sink>(nid, shape, view, board, buffer, halo, sink);
+        }
+        if (found > 0) return found;
+
+        // С фронта мест нет. Любое место можно сдвигать, пока оно не упрется в занятую
+        // клетку или край, и тогда его клетка (или соседняя, на треугольной сетке) окажется
+        // на фронте. Значит якорь любого места не дальше размера фигуры шагов от фронта:
+        // перебираем полосу такой ширины вместо всего поля.
+        if (++board.visit_epoch == 0) {
+            std::fill(board.visit.begin(), board.visit.end(), 0);
+            board.visit_epoch = 1;
+        }
+        const auto& nodes = graph->get_nodes();
+        std::vector<int> band(board.frontier);
+        for(int nid : band) board.visit[nid] = board.visit_epoch;
+        size_t layer_begin = 0;
+        for(size_t depth = 0; depth < shape->size(); ++depth) {
+            size_t layer_end = band.size();
+            for(size_t i = layer_begin; i < layer_end; ++i) {
+                for(int p = 0; p < Ports; ++p) {
+                    int n = nodes[band[i]].get_neighbor(p);
+                    if (n == -1 || board.occupied[n] || board.visit[n] == board.visit_epoch) continue;
+                    board.visit[n] = board.visit_epoch;
+                    band.push_back(n);
+                    found += collect_candidates_at<Policy, Ports, Sink>(n, shape, view, board, buffer, halo, sink);
                 }
             }
+            if (band.size() == layer_end) break;
+            layer_begin = layer_end;
+        }
+        return found;
+    }
+
+    for(int nid = 0; nid < (int)graph->size(); ++nid) {
+        found += collect_candidates_at<Policy, Ports, Sink>(nid, shape, view, board, buffer, halo, sink);
+    }
+    return found;
+}
+
+template <class Policy, int Ports, class Sink>
+int GRASPSolver::collect_candidates_at(int nid, const std::shared_ptr<Figure>& shape, const PlacementView& view,
+                                       const BoardState& board, std::vector<int>& fp, std::vector<int>& halo,
+                                       Sink& sink) {
+    const std::vector<char>& current_occupied_mask = board.occupied;
+    // Если клетка уже занята, пропускаем (O(1) проверка)
+    if (current_occupied_mask[nid]) {
+        return 0;
+    }
+
+    int found = 0;
+
+    // Перебираем все возможные повороты фигуры
+    for(int rot = 0; rot < Ports; ++rot) {
+        // Получаем "след" фигуры (список занимаемых клеток): из таблицы размещений или
+        // get_embedding, который возвращает пустой вектор, если фигура выходит за границы поля
+        if (view) {
+            const int* cells = view.footprint(nid, rot);
+            if (!cells) continue;
+            fp.assign(cells, cells + shape->size());
+        } else {
+            fp = graph->get_embedding(shape, nid, rot);
+            if (fp.empty()) continue;
+        }
+        
+        // Проверка на коллизии с уже установленными фигурами
+        bool clash = false;
+        for(int f_id : fp) {
+            if (current_occupied_mask[f_id]) { 
+                clash = true; 
+                break; 
+            }
+        }
+        
+        if (!clash) {
+            // Ход валиден. Вычисляем его эвристическую ценность. Ореол - из таблицы,
+            // а без нее (таблица не поместилась в кэш) - обходом соседей следа
+            scoring::Candidate candidate{fp.data(), fp.size(), nullptr, 0,
+                                         current_occupied_mask, board.contacts, boundary_ports};
+            if (Policy::NEEDS_HALO) {
+                if (view && view.table->has_halos()) {
+                    candidate.halo = view.halo(nid, rot);
+                    candidate.halo_len = view.table->get_halo_stride();
+                } else {
+                    halo.resize(fp.size() * Ports);
+                    candidate.halo = halo.data();
+                    candidate.halo_len = footprint_halo(*graph, fp.data(), fp.size(), halo.data());
+                }
+            }
+            int score = Policy::template score<Ports>(candidate);
+            sink(nid, rot, fp, score);
+            found++;
+        }
+    }
+    return found;
+}
+
+// Вариант DLX без полного перебора: кандидаты в "зажатые" клетки выбираются по счетчикам
+// касаний board.contacts (больше занятых соседей - меньше способов накрыть клетку),
+// и только для них места фигуры считаются точно - перебором якорей вблизи клетки.
+// Из проверенных клеток уровня с наибольшим числом касаний, которые вообще можно
+// накрыть, берется клетка с наименьшим числом накрытий. Клетки, которые не накрыть ничем,
+// пропускаем: в упаковке дыры допустимы, в отличие от точного покрытия.
+// Если ни одна проверенная клетка не накрывается, перебираются все места.
+void GRASPSolver::collect_constrained_candidates(const std::shared_ptr<Figure>& shape, const BoardState& board,
+                                                 std::mt19937& rng, std::vector<SinglePlacement>& out) {
+    // Сколько клеток каждого уровня касаний проверять
+    constexpr int probes = 16;
+    constexpr int max_ports = 6;
+    int ports = (int)graph->get_max_ports();
+    // Равномерная выборка до probes клеток каждого уровня (reservoir sampling) за один проход
+    int sample[max_ports + 1][probes];
+    int seen[max_ports + 1] = {};
+    auto consider = [&](int nid) {
+        if (board.occupied[nid]) return;
+        int level = board.contacts[nid];
+        // Клетка, замурованная со всех сторон, накрывается только фигурой из одной клетки
+        if (level == ports && shape->size() > 1) return;
+        int j = seen[level]++;
+        if (j >= probes) j = std::uniform_int_distribution<int>(0, j)(rng);
+        if (j < probes) sample[level][j] = nid;
+    };
+    if (config.enumeration == CandidateEnumeration::FRONTIER) {
+        for(int nid : board.frontier) consider(nid);
+    } else {
+        for(int nid = 0; nid < (int)graph->size(); ++nid) consider(nid);
+    }
+
+    std::vector<SinglePlacement> covering;
+    for(int level = ports; level >= 0; --level) {
+        int count = std::min(seen[level], probes);
+        int ties = 0;
+        for(int i = 0; i < count; ++i) {
+            covering.clear();
+            collect_covering(shape, board, sample[level][i], covering);
+            if (covering.empty()) continue;
+            // Минимум с равновероятным выбором среди равных
+            if (out.empty() || covering.size() < out.size()) {
+                out.swap(covering);
+                ties = 1;
+            } else if (covering.size() == out.size() &&
+                       std::uniform_int_distribution<int>(0, ties++)(rng) == 0) {
+                out.swap(covering);
+            }
+        }
+        if (!out.empty()) return;
+    }
+
+    // Запасной путь: все места фигуры и отбор по точным покрытиям
+    collect_candidates(shape, board, [&](int anchor, int rot, std::vector<int>& fp, int score) {
+        out.push_back({shape, anchor, rot, fp, score});
+    });
+    keep_most_constrained_cell(out, rng);
+}
+
+// Якорь места, накрывающего cell, - клетка фигуры, то есть свободная клетка не дальше
+// (размер фигуры - 1) шагов от cell по свободным клеткам. Перебираются только такие якоря.
+void GRASPSolver::collect_covering(const std::shared_ptr<Figure>& shape, const BoardState& board, int cell,
+                                   std::vector<SinglePlacement>& out) {
+    const auto& nodes = graph->get_nodes();
+    size_t ports = graph->get_max_ports();
+    std::vector<int> ball = {cell};
+    size_t layer_begin = 0;
+    for(size_t depth = 1; depth < shape->size(); ++depth) {
+        size_t layer_end = ball.size();
+        for(size_t i = layer_begin; i < layer_end; ++i) {
+            for(size_t p = 0; p < ports; ++p) {
+                int n = nodes[ball[i]].get_neighbor(p);
+                if (n != -1 && !board.occupied[n] && std::find(ball.begin(), ball.end(), n) == ball.end()) {
+                    ball.push_back(n);
+                }
+            }
+        }
+        if (ball.size() == layer_end) break;
+        layer_begin = layer_end;
+    }
+
+    collect_candidates(shape, board, [&](int anchor, int rot, std::vector<int>& fp, int score) {
+        if (std::find(fp.begin(), fp.end(), cell) != fp.end()) out.push_back({shape, anchor, rot, fp, score});
+    }, &ball);
+}
+
+// Оставляет только кандидатов, накрывающих свободную клетку с наименьшим
+// (но ненулевым) числом допустимых накрытий. Клетки, которые не накрыть ничем,
+// пропускаем: в упаковке дыры допустимы, в отличие от точного покрытия.
+void GRASPSolver::keep_most_constrained_cell(std::vector<SinglePlacement>& candidates, std::mt19937& rng) const {
+    if (candidates.empty()) return;
+
+    std::vector<int> coverage(graph->size(), 0);
+    for(const auto& c : candidates) {
+        for(int f_id : c.footprint) {
+            coverage[f_id]++;
+        }
+    }
+
+    // Минимум ищем с равновероятным выбором среди равных (reservoir sampling)
+    int best_cell = -1;
+    int best_count = 0;
+    int ties = 0;
+    for(size_t nid = 0; nid < coverage.size(); ++nid) {
+        int cnt = coverage[nid];
+        if (cnt == 0) continue;
+        if (best_cell == -1 || cnt < best_count) {
+            best_cell = (int)nid;
+            best_count = cnt;
+            ties = 1;
+        } else if (cnt == best_count) {
+            ties++;
+            if (std::uniform_int_distribution<int>(0, ties - 1)(rng) == 0) {
+                best_cell = (int)nid;
+            }
+        }
+    }
+
+    auto misses_cell = [best_cell](const SinglePlacement& c) {
+        return std::find(c.footprint.begin(), c.footprint.end(), best_cell) == c.footprint.end();
+    };
+    candidates.erase(std::remove_if(candidates.begin(), candidates.end(), misses_cell), candidates.end());
+}
+
+void GRASPSolver::occupy(BoardState& board, const std::vector<int>& footprint) const {
+    const auto& nodes = graph->get_nodes();
+    size_t ports = graph->get_max_ports();
+    bool frontier = config.enumeration == CandidateEnumeration::FRONTIER;
+    for(int fid : footprint) {
+        board.occupied[fid] = 1;
+        board.hash ^= zobrist[fid];
+        if (frontier) frontier_remove(board, fid);
+    }
+    // Свободные соседи фигуры получают касание и становятся частью фронта
+    for(int fid : footprint) {
+        for(size_t p = 0; p < ports; ++p) {
+            int n = nodes[fid].get_neighbor(p);
+            if (n == -1) continue;
+            board.contacts[n]++;
+            if (frontier && !board.occupied[n]) frontier_add(board, n);
+        }
+    }
+}
+
+void GRASPSolver::release(BoardState& board, const std::vector<int>& footprint) const {
+    const auto& nodes = graph->get_nodes();
+    size_t ports = graph->get_max_ports();
+    bool frontier = config.enumeration == CandidateEnumeration::FRONTIER;
+    for(int fid : footprint) {
+        board.occupied[fid] = 0;
+        board.hash ^= zobrist[fid];
+    }
+    // Соседи, у которых не осталось касаний, уходят с фронта; освобожденные клетки
+    // с касаниями возвращаются на него
+    for(int fid : footprint) {
+        for(size_t p = 0; p < ports; ++p) {
+            int n = nodes[fid].get_neighbor(p);
+            if (n == -1) continue;
+            board.contacts[n]--;
+            if (frontier && board.contacts[n] == 0) frontier_remove(board, n);
+        }
+    }
+    if (frontier) {
+        for(int fid : footprint) {
+            if (board.contacts[fid] > 0) frontier_add(board, fid);
         }
     }
-    return neighbors;
 }
 
 // Рекурсивная функция размещения фигур (Backtracking with RCL)
 // Реализует поиск в глубину с возвратом.
-// Аргументы передаются по ссылке для избежания копирования тяжелых структур.
+// Ход делается прямо в board и откатывается при неудаче, поэтому маска не копируется.
 bool GRASPSolver::place_shapes_recursive(
     int shape_idx, 
-    const std::vector<std::shared_ptr<Figure>>& shapes, 
-    std::vector<char>& current_occupied_mask, 
+    const Bundle& bundle, 
+    BoardState& board, 
     std::vector<SinglePlacement>& out_placements,
-    std::mt19937& rng
+    SearchContext& ctx
 ) {
+    const std::vector<std::shared_ptr<Figure>>& shapes = bundle.get_shapes();
     // если все разместили
     if (shape_idx >= (int)shapes.size()) {
         return true; 
     }
-
-    const std::shared_ptr<Figure>& shape = shapes[shape_idx];
-    std::vector<SinglePlacement> candidates;
-    
-    // 1. Поиск всех возможных мест для текущей фигуры
-    for(const auto& node : graph->get_nodes()) {
-        int nid = node.get_id();
-        // Если клетка уже занята, пропускаем (O(1) проверка)
-        if (current_occupied_mask[nid]) {
-            continue;
-        }
-
-        // Перебираем все возможные повороты фигуры
-        for(int rot = 0; rot < graph->get_max_ports(); ++rot) {
-            // Получаем "след" фигуры (список занимаемых клеток)
-            // get_embedding возвращает пустой вектор, если фигура выходит за границы поля
-            std::vector<int> fp = graph->get_embedding(shape, nid, rot);
-            
-            if (fp.empty()) {
-                continue;
-            }
-            
-            // Проверка на коллизии с уже установленными фигурами
-            bool clash = false;
-            for(int f_id : fp) {
-                if (current_occupied_mask[f_id]) { 
-                    clash = true; 
-                    break; 
-                }
-            }
-            
-            if (!clash) {
-                // Ход валиден. Вычисляем его эвристическую ценность.
-                int score = calculate_placement_score(fp, current_occupied_mask);
-                SinglePlacement placement;
-                placement.figure = shape;
-                placement.anchor = nid;
-                placement.rotation = rot;
-                placement.footprint = fp;
-                placement.score = score;
-                candidates.push_back(placement);
-            }
-        }
+    ctx.exhausted = false;
+    if (ctx.cancelled()) {
+        return false;
     }
-    
-    // Если кандидатов нет - тупик, возвращаемся назад
-    if (candidates.empty()) {
+    std::mt19937& rng = ctx.rng;
+
+    // Ключ состояния (бандл, номер фигуры, занятость). Если из него уже доказано, что
+    // бандл не достраивается, не тратим время на повторный перебор.
+    uint64_t state_key = mix64(board.hash ^ mix64(((uint64_t)bundle.get_id() << 32) | (uint32_t)shape_idx));
+    if (failed_states.contains(state_key)) {
+        ctx.exhausted = true;
         return false;
     }
 
-    // 2. Построение RCL (Restricted Candidate List)
+    const std::shared_ptr<Figure>& shape = shapes[shape_idx];
+
+    // Ограничиваем ветвление: проверяем не более 5 лучших вариантов.
+    // Это предотвращает комбинаторный взрыв при глубокой рекурсии.
+    const int max_tries = 5;
+
+    // 1-2. Поиск мест для текущей фигуры и построение RCL (Restricted Candidate List).
     // Это ключевой момент GRASP: мы берем не просто лучший вариант (Greedy),
-    // а список "достаточно хороших" вариантов, чтобы добавить вариативность.
-    int max_score = -9999;
-    for(const auto& c : candidates) {
-        if(c.score > max_score) {
-            max_score = c.score;
+    // а случайные варианты из "достаточно хороших" (score >= alpha * max_score),
+    // чтобы добавить вариативность. Кандидаты не накапливаются: они сразу
+    // проходят через потоковую выборку размера max_tries.
+    float alpha = ctx.alpha; // Коэффициент жадности (обычно 0.8 - 0.9)
+    RclReservoir<SinglePlacement> reservoir(max_tries, alpha);
+    // Перебор полный, если кандидаты - все допустимые места фигуры и RCL ни одного не отсеял.
+    // Фронт (FRONTIER) перебирает внутренние клетки, только когда на нем мест нет
+    bool complete = config.enumeration == CandidateEnumeration::FULL;
+    auto offer = [&](int anchor, int rot, std::vector<int>& fp, int score) {
+        reservoir.offer(score, [&]() {
+            SinglePlacement placement;
+            placement.figure = shape;
+            placement.anchor = anchor;
+            placement.rotation = rot;
+            placement.footprint = fp;
+            placement.score = score;
+            return placement;
+        }, rng);
+    };
+
+    if (config.branching == BranchingStrategy::MOST_CONSTRAINED_CELL) {
+        // Вариант DLX: ветвимся только по местам, накрывающим самую "зажатую" клетку
+        std::vector<SinglePlacement> candidates;
+        collect_constrained_candidates(shape, board, rng, candidates);
+        // В упаковке клетку можно и не накрывать, так что отбор по клетке - эвристика
+        complete = false;
+        for(auto& c : candidates) {
+            offer(c.anchor, c.rotation, c.footprint, c.score);
         }
+    } else {
+        collect_candidates(shape, board, offer);
     }
     
-    std::vector<SinglePlacement> rcl;
-    float alpha = config.alpha; // Коэффициент жадности (обычно 0.8 - 0.9)
-    for(const auto& c : candidates) {
-        // Берем кандидатов, которые не хуже alpha * max_score
-        if (c.score >= max_score * alpha || (max_score <= 0)) {
-            rcl.push_back(c);
-        }
+    // Если кандидатов нет - тупик, возвращаемся назад
+    if (reservoir.size() == 0) {
+        failed_states.insert(state_key);
+        ctx.exhausted = true;
+        return false;
     }
-    
+
     // Случайный выбор из лучших кандидатов вносит стохастику, 
     // позволяя алгоритму выходить из локальных оптимумов.
-    std::shuffle(rcl.begin(), rcl.end(), rng);
-    
-    // Ограничиваем ветвление: проверяем не более 5 лучших вариантов.
-    // Это предотвращает комбинаторный взрыв при глубокой рекурсии.
-    int max_tries = 5;
-    if (rcl.size() < 5) {
-        max_tries = (int)rcl.size();
+    std::vector<SinglePlacement> rcl = reservoir.take(rng);
+    int tries = (int)rcl.size();
+    if ((long long)tries < reservoir.size()) complete = false;
+
+    // Крупный бандл: ветви первой фигуры раздаем потокам пула
+    if (pool && config.parallel_backtracking && shape_idx == 0 && tries > 1 &&
+        (int)shapes.size() >= config.parallel_min_shapes) {
+        // Провал параллельных ветвей в таблицу не пишется: их полноту не отслеживаем
+        bool placed = place_shapes_parallel(bundle, board, rcl, out_placements, ctx);
+        ctx.exhausted = false;
+        return placed;
     }
     
-    for(int i = 0; i < max_tries; ++i) {
+    for(int i = 0; i < tries; ++i) {
         const SinglePlacement& choice = rcl[i];
         
-        // "Делаем ход": Создаем новую маску занятости для следующего шага рекурсии
-        // Копирование вектора char (битовой маски) дешево по памяти.
-        std::vector<char> new_occupied_mask = current_occupied_mask;
-        for(int fid : choice.footprint) {
-            new_occupied_mask[fid] = 1;
-        }
-        
+        // "Делаем ход": отмечаем клетки фигуры и обновляем хеш
+        occupy(board, choice.footprint);
         out_placements.push_back(choice);
         
         // Рекурсивный спуск (Depth-First Search)
-        if (place_shapes_recursive(shape_idx + 1, shapes, new_occupied_mask, out_placements, rng)) {
-            current_occupied_mask = new_occupied_mask; // Успех! Фиксируем изменения
-            return true;
+        if (place_shapes_recursive(shape_idx + 1, bundle, board, out_placements, ctx)) {
+            return true; // Успех! Изменения остаются в board
         }
+        if (!ctx.exhausted) complete = false;
         
         // Откат (Backtracking): Если ветка оказалась тупиковой, 
         // убираем фигуру из решения и пробуем следующего кандидата из RCL.
         out_placements.pop_back();
+        release(board, choice.footprint);
+
+        // Поиск отменен извне - это не тупик, в таблицу не записываем
+        if (ctx.cancelled()) {
+            ctx.exhausted = false;
+            return false;
+        }
     }
     
-    return false; // Ни один из вариантов не подошел
+    // Ни один из вариантов не подошел. Если перебор был полным, это строгий вывод для
+    // любого построения; иначе провал мог быть случайным (RCL, фронт) и не запоминается,
+    // чтобы не отнимать у следующих построений рандомизацию.
+    if (complete) failed_states.insert(state_key);
+    ctx.exhausted = complete;
+    return false;
 }
 
-// Фаза построения решения (Construction Phase)
-GRASPSolver::SolutionState GRASPSolver::run_construction_phase() {
-    SolutionState state;
-    
-    // Сортировка наборов фигур (bundles): сначала пробуем разместить большие и сложные
-    std::vector<int> bundle_indices(bundles.size());
+bool GRASPSolver::place_shapes_parallel(
+    const Bundle& bundle,
+    BoardState& board,
+    const std::vector<SinglePlacement>& rcl,
+    std::vector<SinglePlacement>& out_placements,
+    SearchContext& ctx
+) {
+    // Первая успешная ветка выставляет found, и остальные сворачиваются
+    std::atomic<bool> found{false};
+    std::mutex result_mutex;
+    BoardState result_board;
+    std::vector<SinglePlacement> result_placements;
+
+    {
+        TaskGroup branches(*pool);
+        for(const SinglePlacement& choice : rcl) {
+            unsigned seed = ctx.rng();
+            branches.spawn([&, seed, choice_ptr = &choice]() {
+                if (found.load(std::memory_order_relaxed) || ctx.cancelled()) return;
+
+                // Своя копия поля для каждой ветви
+                BoardState local_board = board;
+                std::vector<SinglePlacement> local_placements = {*choice_ptr};
+                std::mt19937 local_rng(seed);
+                SearchContext local_ctx{local_rng, ctx.alpha, &found};
+
+                occupy(local_board, choice_ptr->footprint);
+                if (place_shapes_recursive(1, bundle, local_board, local_placements, local_ctx)) {
+                    std::lock_guard<std::mutex> lock(result_mutex);
+                    if (!found.exchange(true)) {
+                        result_board = std::move(local_board);
+                        result_placements = std::move(local_placements);
+                    }
+                }
+            });
+        }
+        branches.wait();
+    }
+
+    if (!found.load()) {
+        return false;
+    }
+    board = std::move(result_board);
+    out_placements.insert(out_placements.end(), result_placements.begin(), result_placements.end());
+    return true;
+}
+
+void GRASPSolver::init_learning() {
+    std::lock_guard<std::mutex> lock(learning.mutex);
+    size_t k = learning.alphas.size();
+    learning.score_sum.assign(k, 0.0);
+    learning.uses.assign(k, 0);
+    learning.probability.assign(k, 1.0 / k);
+    learning.best_score = 0.0;
+    learning.since_update = 0;
+    learning.failures.assign(bundles.size(), 0);
+    learning.constructions = 0;
+}
+
+int GRASPSolver::choose_alpha(std::mt19937& rng) {
+    std::lock_guard<std::mutex> lock(learning.mutex);
+    std::discrete_distribution<int> dist(learning.probability.begin(), learning.probability.end());
+    return dist(rng);
+}
+
+// Сначала большие и сложные бандлы. В реактивном режиме "трудные" бандлы поднимаются:
+// площадь умножается на (1 + доля построений, в которых бандл не удалось разместить),
+// так что бандл, который не ставится никогда, идет как вдвое больший.
+std::vector<int> GRASPSolver::construction_order() {
+    std::vector<double> weight(bundles.size());
+    {
+        std::lock_guard<std::mutex> lock(learning.mutex);
+        for(size_t i = 0; i < bundles.size(); ++i) {
+            double fail_rate = (config.reactive && learning.constructions > 0)
+                ? (double)learning.failures[i] / learning.constructions : 0.0;
+            weight[i] = (double)bundles[i].get_total_area() * (1.0 + fail_rate);
+        }
+    }
+
+    std::vector<int> order(bundles.size());
     for(size_t i = 0; i < bundles.size(); ++i) {
-        bundle_indices[i] = i;
+        order[i] = i;
     }
-    
-    // Лямбда-функция для сортировки
-    std::sort(bundle_indices.begin(), bundle_indices.end(), [&](int a, int b) {
-        if (bundles[a].get_total_area() != bundles[b].get_total_area()) {
-            return bundles[a].get_total_area() > bundles[b].get_total_area();
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (weight[a] != weight[b]) {
+            return weight[a] > weight[b];
         }
         return bundles[a].get_shapes().size() > bundles[b].get_shapes().size();
     });
+    return order;
+}
+
+// Если все бандлы на поле не помещаются, часть построений тратится на наборы, которые
+// не могут дать лучшую площадь. Сумма подмножеств по площадям дает лучшую достижимую
+// площадь (оценку сверху) и подмножества для knapsack_targets лучших достижимых сумм.
+void GRASPSolver::init_targets() {
+    targets.clear();
+    next_target = 0;
+    size_t cells = graph->size();
+    std::vector<size_t> weights(bundles.size());
+    size_t total_area = 0;
+    for(size_t i = 0; i < bundles.size(); ++i) {
+        weights[i] = bundles[i].get_total_area();
+        total_area += weights[i];
+    }
+    area_bound = std::min(total_area, cells);
+    if (total_area <= cells || config.knapsack_targets <= 0) return;
+
+    // Порядок обработки - как у построения: при равных суммах в подмножество
+    // попадают бандлы, которые построение ставит первыми
+    std::vector<int> order(bundles.size());
+    for(size_t i = 0; i < bundles.size(); ++i) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return weights[a] > weights[b]; });
+    // На сумму подмножеств - не больше десятой части лимита времени; не успели - нет ни
+    // оценки, ни целей
+    auto dp_deadline = use_deadline
+        ? std::chrono::high_resolution_clock::now() + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+              std::chrono::duration<double>(0.1 * config.max_time_seconds))
+        : SubsetSum::Clock::time_point::max();
+    SubsetSum dp(weights, order, cells, dp_deadline);
+    if (!dp.complete()) return;
+    area_bound = dp.best();
+
+    std::vector<size_t> sums;
+    for(size_t s = dp.best(); s > 0 && (int)sums.size() < config.knapsack_targets; --s) {
+        if (dp.reachable(s)) sums.push_back(s);
+    }
+    for(const auto& subset : dp.subsets(sums)) {
+        std::vector<char> mask(bundles.size(), 0);
+        for(int i : subset) mask[i] = 1;
+        targets.push_back(std::move(mask));
+    }
+}
+
+// Reactive GRASP (Prais, Ribeiro): каждые 10 построений вероятности alpha пересчитываются
+// пропорционально (средний счет с этим alpha / лучший счет)^10. Еще не опробованные
+// значения считаются равными лучшему, чтобы каждое получило шанс.
+void GRASPSolver::record_construction(int alpha_idx, float score, const std::vector<int>& failed_bundles, bool complete) {
+    if (score < 0.0f) return;
+    std::lock_guard<std::mutex> lock(learning.mutex);
+    // Доля неудач бандла считается только по законченным построениям: прерванное
+    // до бандла не пыталось его ставить
+    if (complete) {
+        learning.constructions++;
+        for(int b_idx : failed_bundles) {
+            learning.failures[b_idx]++;
+        }
+    }
+    if (alpha_idx < 0) return;
+
+    learning.score_sum[alpha_idx] += score;
+    learning.uses[alpha_idx]++;
+    learning.best_score = std::max(learning.best_score, (double)score);
+    if (++learning.since_update < 10 || learning.best_score <= 0.0) return;
+    learning.since_update = 0;
+
+    double total = 0.0;
+    for(size_t i = 0; i < learning.alphas.size(); ++i) {
+        double mean = learning.uses[i] > 0 ? learning.score_sum[i] / learning.uses[i] : learning.best_score;
+        learning.probability[i] = std::pow(mean / learning.best_score, 10.0);
+        total += learning.probability[i];
+    }
+    for(double& p : learning.probability) {
+        p = total > 0.0 ? p / total : 1.0 / learning.probability.size();
+    }
+}
+
+// Пополнение элитного пула. Расстояние между решениями - число клеток с разным bundle_id.
+// Решение, близкое к одному из элитных (ближе 2% поля), может только заменить его,
+// если лучше; далекое добавляется в неполный пул или вытесняет худшее.
+void GRASPSolver::offer_elite(const SolutionState& state) {
+    auto distance = [&](const SolutionState& other) {
+        int d = 0;
+        for(size_t nid = 0; nid < state.node_allocations.size(); ++nid) {
+            d += state.node_allocations[nid] != other.node_allocations[nid];
+        }
+        return d;
+    };
+    int min_distance = std::max(1, (int)graph->size() / 50);
+
+    std::lock_guard<std::mutex> lock(elite_mutex);
+    int closest = -1, closest_distance = 0, worst = -1;
+    for(size_t i = 0; i < elite.size(); ++i) {
+        int d = distance(elite[i]);
+        if (closest == -1 || d < closest_distance) {
+            closest = (int)i;
+            closest_distance = d;
+        }
+        if (worst == -1 || elite[i].score < elite[worst].score) worst = (int)i;
+    }
+
+    if (closest != -1 && closest_distance < min_distance) {
+        if (state.score > elite[closest].score) elite[closest] = state;
+    } else if ((int)elite.size() < config.elite_size) {
+        elite.push_back(state);
+    } else if (worst != -1 && state.score > elite[worst].score) {
+        elite[worst] = state;
+    }
+}
+
+// Path relinking: путь от решения from к решению to. На каждом шаге один бандл переносится
+// на его место в to: бандлы, занимающие эти клетки, снимаются и заново размещаются
+// обычным поиском с возвратами (с жадностью построения from). Из кандидатов выбирается шаг с лучшим немедленным
+// изменением площади. Поле меняется инкрементально (occupy/release), а не строится заново.
+// Возвращает лучшую промежуточную точку пути (счет -1, если путь пуст).
+GRASPSolver::SolutionState GRASPSolver::path_relink(const SolutionState& from, const SolutionState& to,
+                                                    std::mt19937& rng) {
+    size_t n = graph->size();
+    SolutionState best;
+    best.score = -1.0f;
+    best.alpha = from.alpha;
+
+    std::vector<int> alloc = from.node_allocations;
+    std::vector<int> fig = from.node_figure_ids;
+    std::vector<std::vector<int>> cells(bundles.size()), guide_cells(bundles.size());
+    int next_fig = 0;
+    for(size_t nid = 0; nid < n; ++nid) {
+        if (alloc[nid] != -1) cells[bundle_index[alloc[nid]]].push_back((int)nid);
+        if (to.node_allocations[nid] != -1) guide_cells[bundle_index[to.node_allocations[nid]]].push_back((int)nid);
+        next_fig = std::max(next_fig, fig[nid] + 1);
+    }
+
+    BoardState board = make_empty_board();
+    for(const auto& c : cells) {
+        if (!c.empty()) occupy(board, c);
+    }
+    float score = from.score;
+
+    std::vector<int> candidates;
+    for(size_t i = 0; i < bundles.size(); ++i) {
+        if (!guide_cells[i].empty() && guide_cells[i] != cells[i]) candidates.push_back((int)i);
+    }
+
+    auto remove_bundle = [&](int bi) {
+        release(board, cells[bi]);
+        for(int c : cells[bi]) {
+            alloc[c] = -1;
+            fig[c] = -1;
+        }
+        cells[bi].clear();
+        score -= (float)bundles[bi].get_total_area();
+    };
+
+    for(int step = 0; step < config.relink_steps && !candidates.empty(); ++step) {
+        // Выбор шага: площадь переносимого бандла (если он еще не стоит) минус площадь вытесняемых
+        int pick = -1;
+        long long pick_delta = 0;
+        int ties = 0;
+        for(size_t k = 0; k < candidates.size(); ++k) {
+            int bi = candidates[k];
+            if (guide_cells[bi] == cells[bi]) continue;
+            long long delta = cells[bi].empty() ? (long long)bundles[bi].get_total_area() : 0;
+            std::vector<int> seen;
+            for(int c : guide_cells[bi]) {
+                int owner = alloc[c] == -1 ? -1 : bundle_index[alloc[c]];
+                if (owner == -1 || owner == bi) continue;
+                if (std::find(seen.begin(), seen.end(), owner) != seen.end()) continue;
+                seen.push_back(owner);
+                delta -= (long long)bundles[owner].get_total_area();
+            }
+            if (pick == -1 || delta > pick_delta) {
+                pick = (int)k;
+                pick_delta = delta;
+                ties = 1;
+            } else if (delta == pick_delta && std::uniform_int_distribution<int>(0, ties++)(rng) == 0) {
+                pick = (int)k;
+            }
+        }
+        if (pick == -1) break;
+        int bi = candidates[pick];
+        candidates.erase(candidates.begin() + pick);
+
+        // Снимаем сам бандл и всех, кто занимает его клетки в to
+        std::vector<int> displaced;
+        if (!cells[bi].empty()) remove_bundle(bi);
+        for(int c : guide_cells[bi]) {
+            if (alloc[c] == -1) continue;
+            int owner = bundle_index[alloc[c]];
+            displaced.push_back(owner);
+            remove_bundle(owner);
+        }
+
+        // Ставим бандл как в to (фигуры перенумеровываются)
+        occupy(board, guide_cells[bi]);
+        std::unordered_map<int, int> fig_map;
+        for(int c : guide_cells[bi]) {
+            alloc[c] = bundles[bi].get_id();
+            auto [it, inserted] = fig_map.insert({to.node_figure_ids[c], next_fig});
+            if (inserted) next_fig++;
+            fig[c] = it->second;
+        }
+        cells[bi] = guide_cells[bi];
+        score += (float)bundles[bi].get_total_area();
+
+        // Вытесненные - обратно на поле, куда получится (сначала крупные)
+        std::sort(displaced.begin(), displaced.end(), [&](int a, int b) {
+            return bundles[a].get_total_area() > bundles[b].get_total_area();
+        });
+        for(int d : displaced) {
+            std::vector<SinglePlacement> placements;
+            SearchContext ctx{rng, from.alpha};
+            if (!place_shapes_recursive(0, bundles[d], board, placements, ctx)) continue;
+            for(const auto& p : placements) {
+                for(int c : p.footprint) {
+                    alloc[c] = bundles[d].get_id();
+                    fig[c] = next_fig;
+                    cells[d].push_back(c);
+                }
+                next_fig++;
+            }
+            std::sort(cells[d].begin(), cells[d].end());
+            score += (float)bundles[d].get_total_area();
+        }
+
+        if (score > best.score) {
+            best.score = score;
+            best.node_allocations = alloc;
+            best.node_figure_ids = fig;
+            best.placed_bundle_ids.clear();
+            for(size_t i = 0; i < bundles.size(); ++i) {
+                if (!cells[i].empty()) best.placed_bundle_ids.push_back(bundles[i].get_id());
+            }
+        }
+    }
+    return best;
+}
+
+// Фаза построения решения (Construction Phase)
+GRASPSolver::SolutionState GRASPSolver::run_construction_phase(std::mt19937& rng) {
+    SolutionState state;
+    
+    // Порядок бандлов и жадность этого построения
+    std::vector<int> bundle_indices = construction_order();
+    if (!targets.empty()) {
+        // Бандлы целевого подмножества (по очереди для построений) - первыми, остальные следом
+        const std::vector<char>& target = targets[next_target++ % targets.size()];
+        std::stable_partition(bundle_indices.begin(), bundle_indices.end(), [&](int b) { return target[b] != 0; });
+    }
+    int alpha_idx = config.reactive ? choose_alpha(rng) : -1;
+    float alpha = alpha_idx >= 0 ? learning.alphas[alpha_idx] : config.alpha;
+    state.alpha = alpha;
+    std::vector<int> failed_bundles;
+    // Счет, с которым построение учитывается в статистике (-1 - не учитывать)
+    float recorded_score = -1.0f;
 
     float current_score = 0.0f;
     state.placed_bundle_ids.clear();
@@ -171,28 +848,51 @@ GRASPSolver::SolutionState GRASPSolver::run_construction_phase() {
     state.node_allocations.assign(graph->size(), -1);
     state.node_figure_ids.assign(graph->size(), -1);
     
-    // Векторная маска вместо сета
-    std::vector<char> occupied_mask(graph->size(), 0);
-    static std::random_device rd;
-    static std::mt19937 g(rd());
+    // Векторная маска вместо сета (+ Zobrist-хеш занятости)
+    BoardState board = make_empty_board();
+
+    // Оптимистичная оценка: текущий счет + min(площадь оставшихся бандлов, свободные клетки),
+    // но не больше лучшей достижимой суммы площадей (area_bound).
+    // Если она не превышает incumbent, продолжать построение бессмысленно.
+    size_t remaining_area = 0;
+    for(const auto& b : bundles) {
+        remaining_area += b.get_total_area();
+    }
+    size_t free_cells = graph->size();
 
     int fig_uid_counter = 0;
 
     // Проходим по всем наборам фигур
     for(int b_idx : bundle_indices) {
         const Bundle& bundle = bundles[b_idx];
+
+        float upper_bound = std::min(current_score + (float)std::min(remaining_area, free_cells),
+                                     (float)area_bound);
+        if (upper_bound <= incumbent->get()) {
+            // Для статистики построение не лучше своей оценки сверху
+            state.aborted = true;
+            recorded_score = upper_bound;
+            break;
+        }
+        // Время вышло (или солвер остановлен извне), а какое-то решение уже есть -
+        // дальше строить незачем. Такое построение в статистику не идет.
+        if (incumbent->get() >= 0.0f &&
+            (stop_requested() || (use_deadline && std::chrono::high_resolution_clock::now() > deadline))) {
+            state.aborted = true;
+            break;
+        }
+        remaining_area -= bundle.get_total_area();
         
         std::vector<SinglePlacement> final_placements;
-        std::vector<char> temp_occupied = occupied_mask;
         
-        // Пытаемся разместить набор целиком
-        bool success = place_shapes_recursive(0, bundle.get_shapes(), temp_occupied, final_placements, g);
+        // Пытаемся разместить набор целиком. При неудаче board возвращается в исходное состояние.
+        SearchContext ctx{rng, alpha};
+        bool success = place_shapes_recursive(0, bundle, board, final_placements, ctx);
         
         if (success) {
             // Если удалось, сохраняем результат
             for(const auto& p : final_placements) {
                 for(int f_id : p.footprint) {
-                    occupied_mask[f_id] = 1;
                     state.node_allocations[f_id] = bundle.get_id();
                     state.node_figure_ids[f_id] = fig_uid_counter;
                 }
@@ -200,65 +900,180 @@ GRASPSolver::SolutionState GRASPSolver::run_construction_phase() {
             }
             state.placed_bundle_ids.push_back(bundle.get_id());
             current_score += (float)bundle.get_total_area();
+            free_cells -= bundle.get_total_area();
+        } else {
+            failed_bundles.push_back(b_idx);
         }
     }
     
     state.score = current_score;
+    if (!state.aborted) recorded_score = current_score;
+    record_construction(alpha_idx, recorded_score, failed_bundles, !state.aborted);
     return state;
 }
 
 SolverResult GRASPSolver::solve() {
     auto start_time = std::chrono::high_resolution_clock::now();
     bool use_timer = (config.max_time_seconds > 0.001);
+    int num_threads = std::max(1, config.num_threads);
+    use_deadline = use_timer;
+    deadline = start_time + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+        std::chrono::duration<double>(config.max_time_seconds));
+
+    init_learning();
+    init_targets();
+    placements.clear();
+    if (placement_cache) {
+        uint64_t grid_hash = grid_topology_hash(*graph);
+        // Ореолы следов нужны только оценкам по свободным клеткам вокруг фигуры
+        bool scoring_needs_halo = config.scoring == ScoringPolicy::PERIMETER || config.scoring == ScoringPolicy::HOLES;
+        // Таблицы - только ускорение: их построение не должно съедать время поиска. Построение
+        // прекращается по флагу остановки или когда прошла половина лимита времени; фигуры
+        // без таблицы вкладываются на лету
+        auto table_deadline = start_time + std::chrono::duration_cast<std::chrono::high_resolution_clock::duration>(
+            std::chrono::duration<double>(0.5 * config.max_time_seconds));
+        bool out_of_time = false;
+        for(const auto& bundle : bundles) {
+            for(const auto& shape : bundle.get_shapes()) {
+                if (placements.count(shape.get())) continue;
+                out_of_time = stop_requested() ||
+                              (use_deadline && std::chrono::high_resolution_clock::now() > table_deadline);
+                if (out_of_time) break;
+                PlacementView view = placement_cache->get(*graph, grid_hash, shape, scoring_needs_halo);
+                if (view) placements[shape.get()] = view;
+            }
+            if (out_of_time) break;
+        }
+    }
+    elite.clear();
 
-    // Сброс статистики (не используется)
-    
-    float best_score = -1.0f;
     SolutionState best_state;
     // Инициализируем пустыми значениями
     best_state.score = -1.0f;
+    std::mutex best_mutex;
+
+    std::atomic<int> iterations_started{0};
+    std::atomic<int> iterations_done{0};
+    std::atomic<int> iterations_aborted{0};
+    std::atomic<int> iterations_relinked{0};
     
     if (config.verbose) {
         std::cout << "GRASP: Запуск оптимизации..." << std::endl;
         if (use_timer) std::cout << "Лимит времени: " << config.max_time_seconds << " сек." << std::endl;
         else std::cout << "Лимит итераций: " << config.max_iterations << std::endl;
+        if (num_threads > 1) std::cout << "Потоков: " << num_threads << std::endl;
+        if (placement_cache) {
+            double load_ms = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start_time).count();
+            std::cout << "Таблиц размещений: " << placements.size() << " (с диска: "
+                      << placement_cache->disk_hits() << "), подготовка " << load_ms << " мс" << std::endl;
+        }
+        if (!targets.empty()) {
+            std::cout << "Оценка сверху по сумме подмножеств: " << area_bound
+                      << ", целевых подмножеств: " << targets.size() << std::endl;
+        }
     }
-    
-    int iter = 0;
-    while(true) {
+
+    // Можно ли начать еще одну итерацию (лимит времени или количества)
+    auto has_budget = [&]() {
+        if (stop_requested()) return false;
+        if (incumbent->get() >= (float)area_bound) return false; // оптимум по площади достигнут
         if (use_timer) {
             auto now = std::chrono::high_resolution_clock::now();
             std::chrono::duration<double> elapsed = now - start_time;
-            if (elapsed.count() > config.max_time_seconds) break;
-        } else {
-            if (iter >= config.max_iterations) break;
+            return elapsed.count() <= config.max_time_seconds;
         }
+        return iterations_started.fetch_add(1) < config.max_iterations;
+    };
 
-        SolutionState current_state = run_construction_phase();
-        
-        if (current_state.score > best_score) {
-            best_score = current_state.score;
-            best_state = current_state;
+    // Одна итерация GRASP. Лучший счет публикуется через общий атомарный incumbent.
+    auto run_iteration = [&](std::mt19937& rng) {
+        SolutionState current_state = run_construction_phase(rng);
+        iterations_done++;
+
+        if (current_state.aborted) {
+            iterations_aborted++;
+            return;
+        }
+        if (config.elite_size > 0) {
+            // Путь от нового решения к случайному элитному
+            SolutionState guide;
+            {
+                std::lock_guard<std::mutex> lock(elite_mutex);
+                if (!elite.empty()) {
+                    guide = elite[std::uniform_int_distribution<size_t>(0, elite.size() - 1)(rng)];
+                }
+            }
+            if (!guide.node_allocations.empty()) {
+                SolutionState relinked = path_relink(current_state, guide, rng);
+                if (relinked.score > current_state.score) {
+                    iterations_relinked++;
+                    current_state = std::move(relinked);
+                }
+            }
+            offer_elite(current_state);
+        }
+        if (incumbent->offer(current_state.score)) {
+            std::lock_guard<std::mutex> lock(best_mutex);
+            if (current_state.score > best_state.score) {
+                best_state = std::move(current_state);
+            }
+        }
+    };
+
+    std::random_device rd;
+    if (num_threads == 1) {
+        std::mt19937 rng(rd());
+        while(has_budget()) {
+            run_iteration(rng);
+        }
+    } else {
+        // Итерации - задачи пула в общей очереди (низший приоритет), поэтому свободный
+        // поток сначала помогает с ветвями крупных бандлов, а потом берет новую итерацию.
+        // Всего работает ровно num_threads потоков.
+        WorkStealingPool workers(num_threads);
+        std::vector<std::mt19937> rngs;
+        for(int t = 0; t < num_threads; ++t) {
+            rngs.emplace_back(rd());
+        }
+
+        pool = &workers;
+        {
+            TaskGroup iterations(workers);
+            std::function<void()> next_iteration = [&]() {
+                if (!has_budget()) return;
+                run_iteration(rngs[workers.current_worker()]);
+                iterations.inject(next_iteration);
+            };
+            for(int t = 0; t < num_threads; ++t) {
+                iterations.inject(next_iteration);
+            }
+            iterations.wait();
+        }
+        pool = nullptr;
+    }
+
+    if (config.verbose) {
+        std::cout << "Итераций: " << iterations_done.load()
+                  << ", прервано по оценке: " << iterations_aborted.load()
+                  << ", улучшено path relinking: " << iterations_relinked.load() << std::endl;
+        if (config.reactive) {
+            std::cout << "Вероятности alpha:";
+            for(size_t i = 0; i < learning.alphas.size(); ++i) {
+                std::cout << " " << learning.alphas[i] << "=" << learning.probability[i];
+            }
+            std::cout << std::endl;
         }
-        iter++;
     }
     
-    // Применение лучшего найденного результата к сетке
+    // Лучший найденный результат - в решение (сетка не меняется)
     placed_bundles = best_state.placed_bundle_ids;
     
-    // Теперь просто проходим по вектору node_allocations
+    Assignment assignment(graph->size());
     if (!best_state.node_allocations.empty()) {
-        for(size_t nid = 0; nid < best_state.node_allocations.size(); ++nid) {
-            int bid = best_state.node_allocations[nid];
-            if (bid != -1) {
-                GridCellData& data = graph->get_node(nid).get_data();
-                data.bundle_id = bid;
-                if (best_state.node_figure_ids[nid] != -1) {
-                    data.figure_id = best_state.node_figure_ids[nid];
-                }
-            }
-        }
+        assignment.bundle_id = std::move(best_state.node_allocations);
+        assignment.figure_id = std::move(best_state.node_figure_ids);
     }
     
-    return { best_score, placed_bundles };
+    return { best_state.score, placed_bundles, std::move(assignment) };
 }
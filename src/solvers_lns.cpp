@@ -0,0 +1,271 @@
+#include "solvers.h"
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <unordered_map>
+#include <chrono>
+
+
+SolverResult LNSSolver::solve() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - start_time;
+        return d.count();
+    };
+    bool use_timer = (config.max_time_seconds > 0.001);
+    int num_threads = std::max(1, config.num_threads);
+    size_t n = graph->size();
+
+    PartialSolution solution(n);
+    if (n == 0 || bundles.empty()) {
+        placed_bundles.clear();
+        return solution.to_result();
+    }
+
+    std::unordered_map<int, int> index_of; // id бандла -> индекс в bundles
+    for (size_t i = 0; i < bundles.size(); ++i) index_of[bundles[i].get_id()] = (int)i;
+
+    // 1. Начальное решение: прежнее (warm start) или GRASP на всем поле, треть времени
+    std::vector<int> dirty; // измененные клетки - первые центры окон
+    if (warm_start) {
+        solution = load_warm_start(*graph, bundles, *warm_start, dirty);
+    } else {
+        SolverConfig initial = config;
+        initial.verbose = false;
+        if (use_timer) initial.max_time_seconds = 0.3 * config.max_time_seconds;
+        std::vector<int> all_cells(n);
+        std::iota(all_cells.begin(), all_cells.end(), 0);
+        solution.commit(all_cells, solve_region(*graph, all_cells, bundles, initial));
+    }
+
+    // Клетки каждого бандла (пусто - бандл не размещен)
+    std::vector<std::vector<int>> bundle_cells(bundles.size());
+    long long covered = 0;
+    for (size_t c = 0; c < n; ++c) {
+        if (solution.cell_bundle[c] == -1) continue;
+        bundle_cells[index_of[solution.cell_bundle[c]]].push_back((int)c);
+        covered++;
+    }
+
+    // Досборка после warm start: свободные клетки на расстоянии до lns_radius от измененных
+    // (по свободным клеткам) заполняются неразмещенными бандлами
+    if (!dirty.empty()) {
+        std::vector<int> depth(n, -1);
+        std::vector<int> region;
+        for (int c : dirty) {
+            if (solution.cell_bundle[c] != -1 || depth[c] != -1) continue;
+            depth[c] = 0;
+            region.push_back(c);
+        }
+        for (size_t head = 0; head < region.size(); ++head) {
+            int u = region[head];
+            if (depth[u] >= config.lns_radius) continue;
+            for (int v : graph->get_node(u).get_all_neighbors()) {
+                if (v == -1 || depth[v] != -1 || solution.cell_bundle[v] != -1) continue;
+                depth[v] = depth[u] + 1;
+                region.push_back(v);
+            }
+        }
+
+        std::vector<Bundle> missing;
+        for (size_t i = 0; i < bundles.size(); ++i) {
+            if (bundle_cells[i].empty()) missing.push_back(bundles[i]);
+        }
+        SolverConfig patch = make_region_config(config, use_timer ? 0.3 * config.max_time_seconds : 0.0);
+        patch.max_iterations = std::max(1, config.lns_repair_iterations);
+        RegionSolution result = solve_region(*graph, region, missing, patch);
+        solution.commit(region, result);
+        for (size_t i = 0; i < region.size(); ++i) {
+            int bid = result.cell_bundle[i];
+            if (bid == -1) continue;
+            bundle_cells[index_of[bid]].push_back(region[i]);
+            covered++;
+        }
+    }
+
+    if (config.verbose) {
+        std::cout << "LNS: начальное решение " << covered << " / " << n;
+        if (warm_start) std::cout << " (warm start, измененных клеток " << dirty.size() << ")";
+        std::cout << ", время: " << elapsed() << " сек." << std::endl;
+    }
+
+    // Восстановление окна - фиксированное число итераций GRASP, без лимита времени:
+    // окна маленькие, и стоимость хода должна быть предсказуемой
+    SolverConfig repair = make_region_config(config, 0.0);
+    repair.max_time_seconds = 0.0;
+    repair.max_iterations = std::max(1, config.lns_repair_iterations);
+    // Окно окружено занятыми клетками: при оценке по касаниям фигуры прижимаются и к его стенкам
+    if (repair.scoring == ScoringPolicy::CONTACT) repair.scoring = ScoringPolicy::EDGES;
+
+    // Ход: окно, снятые бандлы и результат восстановления
+    struct Move {
+        std::vector<int> cells;   // клетки подзадачи: окно + клетки снятых бандлов
+        std::vector<int> freed;   // индексы снятых бандлов
+        std::vector<int> candidates;
+        long long old_score = 0;
+        RegionSolution result;
+    };
+
+    WorkStealingPool workers(num_threads);
+    std::random_device rd;
+    std::mt19937 rng(rd());
+    std::shuffle(dirty.begin(), dirty.end(), rng);
+
+    std::vector<int> round_mark(n, 0);        // клетка уже занята окном текущего раунда
+    std::vector<int> visit_mark(n, 0);        // метка обхода окна
+    std::vector<int> bundle_mark(bundles.size(), 0);
+    int visit = 0;
+    int rounds = 0, moves_tried = 0, moves_accepted = 0, moves_improved = 0;
+
+    auto has_budget = [&]() {
+        if (covered == (long long)n) return false; // все поле покрыто - лучше не бывает
+        if (stop_requested()) return false;
+        if (use_timer) return elapsed() <= config.max_time_seconds;
+        return rounds < config.max_iterations;
+    };
+
+    while (has_budget()) {
+        rounds++;
+
+        std::vector<int> unplaced;
+        for (size_t i = 0; i < bundles.size(); ++i) {
+            if (bundle_cells[i].empty()) unplaced.push_back((int)i);
+        }
+        std::shuffle(unplaced.begin(), unplaced.end(), rng);
+        if (unplaced.empty()) break; // все бандлы уже размещены
+        long long min_unplaced_area = (long long)n;
+        for (int bi : unplaced) {
+            min_unplaced_area = std::min(min_unplaced_area, (long long)bundles[bi].get_total_area());
+        }
+
+        std::vector<int> free_cells;
+        for (size_t c = 0; c < n; ++c) {
+            if (solution.cell_bundle[c] == -1) free_cells.push_back((int)c);
+        }
+
+        // 2. Выбор непересекающихся окон (по одному на поток)
+        std::vector<Move> moves;
+        for (int w = 0; w < num_threads; ++w) {
+            // Центр - свободная клетка: там есть что улучшать. Сначала измененные клетки,
+            // которые еще свободны, затем случайные
+            int center = -1;
+            while (!dirty.empty() && center == -1) {
+                int c = dirty.back();
+                dirty.pop_back();
+                if (solution.cell_bundle[c] == -1 && round_mark[c] != rounds) center = c;
+            }
+            if (center == -1) {
+                center = free_cells[std::uniform_int_distribution<size_t>(0, free_cells.size() - 1)(rng)];
+            }
+            if (round_mark[center] == rounds) continue;
+
+            // Окно - обход в ширину от центра. Растет кольцами, пока в нем не наберется
+            // свободных клеток на самый маленький неразмещенный бандл, но не дальше lns_radius.
+            visit++;
+            std::vector<int> window = {center};
+            size_t ring_begin = 0;
+            long long window_free = solution.cell_bundle[center] == -1 ? 1 : 0;
+            visit_mark[center] = visit;
+            for (int ring = 0; ring < config.lns_radius && window_free < min_unplaced_area; ++ring) {
+                size_t ring_end = window.size();
+                for (size_t head = ring_begin; head < ring_end; ++head) {
+                    for (int v : graph->get_node(window[head]).get_all_neighbors()) {
+                        if (v == -1 || visit_mark[v] == visit) continue;
+                        visit_mark[v] = visit;
+                        window.push_back(v);
+                        if (solution.cell_bundle[v] == -1) window_free++;
+                    }
+                }
+                ring_begin = ring_end;
+            }
+
+            Move move;
+            for (int c : window) {
+                int bid = solution.cell_bundle[c];
+                if (bid == -1) {
+                    move.cells.push_back(c);
+                    continue;
+                }
+                int bi = index_of[bid];
+                if (bundle_mark[bi] == visit) continue;
+                bundle_mark[bi] = visit;
+                move.freed.push_back(bi);
+                move.old_score += (long long)bundles[bi].get_total_area();
+                move.cells.insert(move.cells.end(), bundle_cells[bi].begin(), bundle_cells[bi].end());
+            }
+
+            bool overlaps = false;
+            for (int c : move.cells) overlaps = overlaps || round_mark[c] == rounds;
+            if (overlaps) continue;
+            for (int c : move.cells) round_mark[c] = rounds;
+
+            // Кандидаты: снятые бандлы и неразмещенные, пока хватает свободной площади окна.
+            // Если не помещается ни один, добавляется один неразмещенный сверх площади -
+            // тогда ход может заменить снятый бандл более крупным.
+            move.candidates = move.freed;
+            long long room = (long long)move.cells.size() - move.old_score;
+            int spare = -1;
+            for (int& bi : unplaced) {
+                if (bi == -1) continue;
+                long long area = (long long)bundles[bi].get_total_area();
+                if (area > room) {
+                    if (spare == -1 && area <= (long long)move.cells.size()) spare = bi;
+                    continue;
+                }
+                move.candidates.push_back(bi);
+                room -= area;
+                bi = -1; // бандл достается только одному окну раунда
+            }
+            if (move.candidates.size() == move.freed.size()) {
+                if (spare == -1) continue;
+                move.candidates.push_back(spare);
+                *std::find(unplaced.begin(), unplaced.end(), spare) = -1;
+            }
+
+            moves.push_back(std::move(move));
+        }
+
+        // 3. Параллельное восстановление окон
+        {
+            TaskGroup group(workers);
+            for (auto& move : moves) {
+                group.inject([&]() {
+                    std::vector<Bundle> subset;
+                    for (int bi : move.candidates) subset.push_back(bundles[bi]);
+                    // Ищем решения не хуже текущего: равные тоже принимаются и разнообразят поиск
+                    move.result = solve_region(*graph, move.cells, subset, repair, move.old_score - 0.5f);
+                });
+            }
+            group.wait();
+        }
+
+        // 4. Принятие ходов, не уменьшающих занятую площадь
+        for (auto& move : moves) {
+            moves_tried++;
+            if ((long long)move.result.score < move.old_score) continue;
+            moves_accepted++;
+            if ((long long)move.result.score > move.old_score) moves_improved++;
+            covered += (long long)move.result.score - move.old_score;
+
+            for (int bi : move.freed) bundle_cells[bi].clear();
+            solution.commit(move.cells, move.result);
+            for (size_t i = 0; i < move.cells.size(); ++i) {
+                int bid = move.result.cell_bundle[i];
+                if (bid != -1) bundle_cells[index_of[bid]].push_back(move.cells[i]);
+            }
+        }
+    }
+
+    // 5. Итог: запись в сетку
+    SolverResult result = solution.to_result();
+    placed_bundles = result.placed_bundles;
+
+    if (config.verbose) {
+        std::cout << "LNS: раундов " << rounds << ", ходов " << moves_tried
+                  << ", принято " << moves_accepted << ", улучшений " << moves_improved
+                  << ", итог " << covered << " / " << n << ", время: " << elapsed() << " сек." << std::endl;
+    }
+
+    return result;
+}
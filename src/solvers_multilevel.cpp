@@ -0,0 +1,305 @@
+#include "solvers.h"
+#include <iostream>
+#include <algorithm>
+#include <numeric>
+#include <vector>
+#include <queue>
+#include <chrono>
+
+
+template <typename T>
+MultilevelSolver::Level MultilevelSolver::coarsen(const Graph<T>& fine, const std::vector<int>& fine_owner) {
+    Level level;
+
+    // Суперклетка - блок 2x2 по координатам узлов. Индексируем блоки через плотный массив.
+    int max_x = 0, max_y = 0;
+    for (const auto& node : fine.get_nodes()) {
+        max_x = std::max(max_x, node.get_data().x);
+        max_y = std::max(max_y, node.get_data().y);
+    }
+    int blocks_x = max_x / 2 + 1;
+    std::vector<int> block_id((size_t)blocks_x * (max_y / 2 + 1), -1);
+
+    level.parent.resize(fine.size());
+    for (const auto& node : fine.get_nodes()) {
+        int cx = node.get_data().x / 2;
+        int cy = node.get_data().y / 2;
+        int& id = block_id[(size_t)cy * blocks_x + cx];
+        if (id == -1) {
+            CoarseCellData data;
+            data.x = cx;
+            data.y = cy;
+            id = level.graph.add_node(data);
+        }
+        level.parent[node.get_id()] = id;
+    }
+
+    // Ребро между суперклетками, если между их узлами есть ребро. Порты занимаются по порядку;
+    // у блоков неквадратных сеток соседей может оказаться больше MAX_PORTS_CAPACITY -
+    // лишние связи отбрасываются, граф уровней нужен только для выбора соседних регионов.
+    for (const auto& node : fine.get_nodes()) {
+        int pu = level.parent[node.get_id()];
+        for (size_t p = 0; p < fine.get_max_ports(); ++p) {
+            int v = node.get_neighbor(p);
+            if (v == -1) continue;
+            int pv = level.parent[v];
+            if (pv == pu) continue;
+            auto& coarse_node = level.graph.get_node(pu);
+            const auto& ports = coarse_node.get_all_neighbors();
+            if (std::find(ports.begin(), ports.end(), pv) != ports.end()) continue;
+            auto free_port = std::find(ports.begin(), ports.end(), -1);
+            if (free_port == ports.end()) continue;
+            coarse_node.set_neighbor(free_port - ports.begin(), pv);
+        }
+    }
+
+    level.fine_owner.resize(fine_owner.size());
+    for (size_t c = 0; c < fine_owner.size(); ++c) {
+        int owner = level.parent[fine_owner[c]];
+        level.fine_owner[c] = owner;
+        level.graph.get_node(owner).get_data().capacity++;
+    }
+    return level;
+}
+
+SolverResult MultilevelSolver::solve() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - start_time;
+        return d.count();
+    };
+    bool use_timer = (config.max_time_seconds > 0.001);
+    int num_threads = std::max(1, config.num_threads);
+
+    PartialSolution solution(graph->size());
+    if (graph->size() == 0 || bundles.empty()) {
+        placed_bundles.clear();
+        return solution.to_result();
+    }
+
+    // 1. Иерархия огрублений до одной суперклетки (или пока размер уменьшается)
+    std::vector<int> identity(graph->size());
+    std::iota(identity.begin(), identity.end(), 0);
+    std::vector<Level> levels;
+    levels.push_back(coarsen(*graph, identity));
+    while (levels.back().graph.size() > 1) {
+        Level next = coarsen(levels.back().graph, levels.back().fine_owner);
+        if (next.graph.size() == levels.back().graph.size()) break;
+        levels.push_back(std::move(next));
+    }
+    int top = (int)levels.size() - 1;
+
+    // 2. Уровень распределения: первый, где в суперклетку в среднем помещается coarse_bundles бандлов
+    double total_area = 0.0;
+    for (const auto& b : bundles) total_area += (double)b.get_total_area();
+    double target = std::max(1, config.coarse_bundles) * total_area / bundles.size();
+    int assign_level = top;
+    for (int l = 0; l <= top; ++l) {
+        if ((double)graph->size() / levels[l].graph.size() >= target) {
+            assign_level = l;
+            break;
+        }
+    }
+
+    // Распределение: от крупных бандлов к мелким, в суперклетку с наибольшим остатком емкости
+    std::vector<int> order(bundles.size());
+    for (size_t i = 0; i < bundles.size(); ++i) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return bundles[a].get_total_area() > bundles[b].get_total_area();
+    });
+
+    const CoarseGraph& assign_graph = levels[assign_level].graph;
+    std::vector<std::vector<int>> pending(assign_graph.size());
+    std::priority_queue<std::pair<long long, int>> capacity;
+    for (const auto& node : assign_graph.get_nodes()) {
+        capacity.push({(long long)node.get_data().capacity, node.get_id()});
+    }
+    std::vector<int> unassigned;
+    for (int bi : order) {
+        auto [left, u] = capacity.top();
+        long long area = (long long)bundles[bi].get_total_area();
+        if (left < area) {
+            unassigned.push_back(bi);
+            continue;
+        }
+        capacity.pop();
+        pending[u].push_back(bi);
+        capacity.push({left - area, u});
+    }
+
+    if (config.verbose) {
+        std::cout << "Multilevel: уровней " << levels.size() << ", распределение на уровне " << assign_level
+                  << " (" << assign_graph.size() << " суперклеток)" << std::endl;
+    }
+
+    WorkStealingPool workers(num_threads);
+
+    // 3. Уточнение снизу вверх: суперклетки уровня решаются параллельно на своих свободных
+    // клетках, неразмещенные бандлы передаются родителю (или его соседу с большим запасом).
+    // Верхние уровни (вплоть до всего поля) не решаются: регионы остаются ограниченными.
+    int last = std::min(top, assign_level + std::max(0, config.coarse_levels_up));
+    std::vector<int> leftovers;
+    for (int l = assign_level; l <= last; ++l) {
+        const Level& level = levels[l];
+
+        // Время вышло или остановка извне: верхние уровни уже не запускаем
+        if (l > assign_level && (stop_requested() || (use_timer && elapsed() >= config.max_time_seconds))) {
+            for (const auto& list : pending) leftovers.insert(leftovers.end(), list.begin(), list.end());
+            break;
+        }
+
+        // Регион суперклетки - ее свободные клетки. Компоненты связности свободных клеток,
+        // в которые не помещается даже самая маленькая фигура из бандлов региона, отбрасываются:
+        // на верхних уровнях это большая часть мелких дыр, и подзадачи становятся заметно меньше.
+        std::vector<size_t> min_shape(level.graph.size(), 0);
+        for (size_t u = 0; u < pending.size(); ++u) {
+            for (int bi : pending[u]) {
+                for (const auto& shape : bundles[bi].get_shapes()) {
+                    if (min_shape[u] == 0 || shape->size() < min_shape[u]) min_shape[u] = shape->size();
+                }
+            }
+        }
+
+        std::vector<std::vector<int>> region_cells(level.graph.size());
+        std::vector<char> visited(graph->size(), 0);
+        std::vector<int> component;
+        for (size_t c = 0; c < graph->size(); ++c) {
+            if (visited[c] || solution.cell_bundle[c] != -1) continue;
+            int u = level.fine_owner[c];
+            if (pending[u].empty()) continue;
+
+            component.clear();
+            component.push_back((int)c);
+            visited[c] = 1;
+            for (size_t head = 0; head < component.size(); ++head) {
+                for (int v : graph->get_node(component[head]).get_all_neighbors()) {
+                    if (v == -1 || visited[v] || solution.cell_bundle[v] != -1) continue;
+                    if (level.fine_owner[v] != u) continue;
+                    visited[v] = 1;
+                    component.push_back(v);
+                }
+            }
+            if (component.size() < min_shape[u]) continue;
+            region_cells[u].insert(region_cells[u].end(), component.begin(), component.end());
+        }
+
+        int active = 0;
+        for (const auto& p : pending) active += p.empty() ? 0 : 1;
+        int waves = (active + num_threads - 1) / num_threads;
+        double level_budget = 0.0;
+        if (use_timer) {
+            double left = std::max(0.0, config.max_time_seconds - elapsed());
+            // Нижнему уровню - половина времени, остальным поровну от остатка
+            level_budget = (l == assign_level && l < last) ? 0.5 * left : left / (last - l + 1);
+        }
+        SolverConfig cfg = make_region_config(config, waves > 0 ? level_budget / waves : 0.0);
+
+        std::vector<RegionSolution> results(level.graph.size());
+        {
+            TaskGroup group(workers);
+            for (size_t u = 0; u < pending.size(); ++u) {
+                if (pending[u].empty()) continue;
+                group.inject([&, u]() {
+                    std::vector<Bundle> subset;
+                    for (int bi : pending[u]) subset.push_back(bundles[bi]);
+                    results[u] = solve_region(*graph, region_cells[u], subset, cfg);
+                });
+            }
+            group.wait();
+        }
+
+        std::vector<std::vector<int>> unplaced(level.graph.size());
+        int unplaced_count = 0;
+        for (size_t u = 0; u < pending.size(); ++u) {
+            if (pending[u].empty()) continue;
+            solution.commit(region_cells[u], results[u]);
+            for (int bi : pending[u]) {
+                if (std::find(results[u].placed.begin(), results[u].placed.end(), bundles[bi].get_id())
+                        == results[u].placed.end()) {
+                    unplaced[u].push_back(bi);
+                    unplaced_count++;
+                }
+            }
+        }
+
+        if (config.verbose) {
+            std::cout << "Multilevel: уровень " << l << ", регионов " << active
+                      << ", не размещено " << unplaced_count << ", время: " << elapsed() << " сек." << std::endl;
+        }
+
+        if (l == last) {
+            for (const auto& list : unplaced) leftovers.insert(leftovers.end(), list.begin(), list.end());
+            break;
+        }
+
+        // Передача наверх: свободная емкость родительских суперклеток
+        const Level& upper = levels[l + 1];
+        std::vector<long long> free_capacity(upper.graph.size(), 0);
+        for (size_t c = 0; c < graph->size(); ++c) {
+            if (solution.cell_bundle[c] == -1) free_capacity[upper.fine_owner[c]]++;
+        }
+
+        std::vector<std::pair<int, int>> promoted; // (бандл, суперклетка-родитель)
+        for (size_t u = 0; u < unplaced.size(); ++u) {
+            for (int bi : unplaced[u]) promoted.push_back({bi, upper.parent[u]});
+        }
+        // Не вошедшие при распределении - в суперклетку с наибольшим запасом
+        if (!unassigned.empty()) {
+            int roomiest = (int)(std::max_element(free_capacity.begin(), free_capacity.end()) - free_capacity.begin());
+            for (int bi : unassigned) promoted.push_back({bi, roomiest});
+            unassigned.clear();
+        }
+        std::sort(promoted.begin(), promoted.end(), [&](const auto& a, const auto& b) {
+            return bundles[a.first].get_total_area() > bundles[b.first].get_total_area();
+        });
+
+        pending.assign(upper.graph.size(), {});
+        for (auto [bi, p] : promoted) {
+            int best = p;
+            for (int v : upper.graph.get_node(p).get_all_neighbors()) {
+                if (v != -1 && free_capacity[v] > free_capacity[best]) best = v;
+            }
+            pending[best].push_back(bi);
+            free_capacity[best] -= (long long)bundles[bi].get_total_area();
+        }
+    }
+    leftovers.insert(leftovers.end(), unassigned.begin(), unassigned.end());
+
+    // 4. Глобальный проход для бандлов крупнее любой суперклетки последнего уровня:
+    // ни в одном регионе им не хватило бы места. Остальные неразмещенные бандлы не
+    // ставятся - иначе подзадача размером в поле вернула бы нелинейное время.
+    long long largest = 0;
+    for (const auto& node : levels[last].graph.get_nodes()) {
+        largest = std::max(largest, (long long)node.get_data().capacity);
+    }
+    std::vector<int> oversized;
+    for (int bi : leftovers) {
+        if ((long long)bundles[bi].get_total_area() > largest) oversized.push_back(bi);
+    }
+    if (!oversized.empty() && last < top && !stop_requested() &&
+        !(use_timer && elapsed() >= config.max_time_seconds)) {
+        std::vector<int> free_cells;
+        for (size_t c = 0; c < graph->size(); ++c) {
+            if (solution.cell_bundle[c] == -1) free_cells.push_back((int)c);
+        }
+        std::vector<Bundle> subset;
+        for (int bi : oversized) subset.push_back(bundles[bi]);
+        SolverConfig cfg = make_region_config(config, use_timer ? config.max_time_seconds - elapsed() : 0.0);
+        RegionSolution global = solve_region(*graph, free_cells, subset, cfg);
+        solution.commit(free_cells, global);
+        leftovers.erase(std::remove_if(leftovers.begin(), leftovers.end(), [&](int bi) {
+            return std::find(global.placed.begin(), global.placed.end(), bundles[bi].get_id()) != global.placed.end();
+        }), leftovers.end());
+    }
+
+    // 5. Итог: запись в сетку
+    SolverResult result = solution.to_result();
+    placed_bundles = result.placed_bundles;
+
+    if (config.verbose) {
+        std::cout << "Multilevel: не размещено бандлов: " << leftovers.size()
+                  << ", время: " << elapsed() << " сек." << std::endl;
+    }
+
+    return result;
+}
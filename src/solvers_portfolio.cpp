@@ -0,0 +1,159 @@
+#include "solvers.h"
+#include "utils/SubsetSum.hpp"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <chrono>
+
+
+// Набор по умолчанию: реактивный GRASP, GRASP с фиксированной жадностью и другим ветвлением,
+// лучевой поиск и LNS;
+// на больших полях еще многоуровневая схема. Порядок - приоритет: при нехватке потоков
+// в гонку попадают первые участники (не меньше двух)
+std::vector<PortfolioSolver::Entry> PortfolioSolver::default_entries() const {
+    SolverConfig base = config;
+    base.verbose = false;
+
+    std::vector<Entry> result;
+    result.push_back({"grasp", base});
+
+    SolverConfig mcc = base;
+    mcc.reactive = false;
+    mcc.alpha = 0.6f;
+    mcc.branching = BranchingStrategy::MOST_CONSTRAINED_CELL;
+    result.push_back({"grasp", mcc});
+
+    SolverConfig greedy = base;
+    greedy.reactive = false;
+    greedy.alpha = 0.95f;
+    greedy.enumeration = CandidateEnumeration::FRONTIER;
+    result.push_back({"grasp", greedy});
+
+    result.push_back({"beam", base});
+    result.push_back({"lns", base});
+
+    if (graph->size() > (size_t)4 * base.tile_size * base.tile_size) {
+        result.push_back({"multilevel", base});
+    }
+    return result;
+}
+
+SolverResult PortfolioSolver::solve() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - start_time;
+        return d.count();
+    };
+    bool use_timer = (config.max_time_seconds > 0.001);
+
+    // Участники с неизвестным алгоритмом отбрасываются до дележа потоков
+    std::vector<Entry> race;
+    std::vector<std::string> known = SolverRegistry::instance().names();
+    for (const Entry& entry : entries.empty() ? default_entries() : entries) {
+        if (std::find(known.begin(), known.end(), entry.algo) == known.end()) {
+            std::cerr << "Portfolio: неизвестный алгоритм " << entry.algo << std::endl;
+            continue;
+        }
+        race.push_back(entry);
+    }
+
+    // Потоки делятся между участниками: их не больше num_threads (лишние участники в конце
+    // списка отбрасываются), но не меньше двух - при одном потоке участники делят его по
+    // времени. Оставшиеся потоки достаются первым участникам
+    size_t budget = (size_t)std::max(1, config.num_threads);
+    size_t members = std::min(race.size(), std::max<size_t>(2, budget));
+    if (race.size() > members) {
+        if (config.verbose) {
+            std::cout << "Portfolio: потоков " << budget << ", участников " << race.size()
+                      << " - в гонке первые " << members << std::endl;
+        }
+        race.resize(members);
+    }
+    for (size_t i = 0; i < race.size(); ++i) {
+        race[i].config.num_threads = std::max(1, (int)(budget / race.size() + (i < budget % race.size() ? 1 : 0)));
+    }
+
+    // Оценка сверху: наибольшая сумма площадей бандлов, не превышающая числа клеток
+    std::vector<size_t> weights;
+    std::vector<int> order;
+    size_t total_area = 0;
+    for (const auto& b : bundles) {
+        order.push_back((int)weights.size());
+        weights.push_back(b.get_total_area());
+        total_area += b.get_total_area();
+    }
+    // Сумма подмножеств - не дольше десятой части лимита; прерванная оценкой не служит
+    float upper_bound = (float)std::min(total_area, graph->size());
+    if (total_area > graph->size()) {
+        SubsetSum dp(weights, order, graph->size(),
+                     use_timer ? start_time + std::chrono::duration_cast<SubsetSum::Clock::duration>(
+                                     std::chrono::duration<double>(0.1 * config.max_time_seconds))
+                               : SubsetSum::Clock::time_point::max());
+        if (dp.complete()) upper_bound = (float)dp.best();
+    }
+
+    // Все участники читают одну задачу (сетка не меняется), с общим incumbent и флагом остановки
+    std::atomic<bool> stop_all{false};
+    // Участник, которого не удалось создать, убирается из race: solvers[i] и results[i]
+    // соответствуют race[i]
+    std::vector<std::unique_ptr<Solver>> solvers;
+    for (size_t i = 0; i < race.size();) {
+        auto solver = SolverRegistry::instance().create(race[i].algo, puzzle, race[i].config);
+        if (!solver) {
+            std::cerr << "Portfolio: не удалось создать " << race[i].algo << std::endl;
+            race.erase(race.begin() + i);
+            continue;
+        }
+        solver->share_incumbent(incumbent);
+        solver->set_stop_flag(&stop_all);
+        solver->set_warm_start(warm_start);
+        solver->set_placement_cache(placement_cache);
+        solvers.push_back(std::move(solver));
+        ++i;
+    }
+
+    std::vector<SolverResult> results(solvers.size(), SolverResult{-1.0f, {}, {}});
+    std::atomic<int> finished{0};
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < solvers.size(); ++i) {
+        threads.emplace_back([&, i]() {
+            results[i] = solvers[i]->solve();
+            incumbent->offer(results[i].score);
+            finished++;
+        });
+    }
+
+    // Следим за гонкой: оптимум найден, время вышло или остановка извне
+    while (finished.load() < (int)threads.size()) {
+        if (incumbent->get() >= upper_bound ||
+            (use_timer && elapsed() > config.max_time_seconds) || stop_requested()) {
+            stop_all.store(true);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    for (auto& t : threads) t.join();
+
+    // Победитель - лучший счет; его решение переносится в нашу сетку
+    int winner = -1;
+    for (size_t i = 0; i < results.size(); ++i) {
+        if (winner == -1 || results[i].score > results[winner].score) winner = (int)i;
+    }
+
+    if (config.verbose) {
+        for (size_t i = 0; i < results.size(); ++i) {
+            std::cout << "Portfolio: #" << i << " " << race[i].algo << " -> "
+                      << results[i].score << ((int)i == winner ? "  <- лучший" : "") << std::endl;
+        }
+        std::cout << "Portfolio: время " << elapsed() << " сек."
+                  << (incumbent->get() >= upper_bound ? ", достигнут оптимум" : "") << std::endl;
+    }
+
+    if (winner == -1 || results[winner].score < 0.0f) {
+        placed_bundles.clear();
+        return {0.0f, placed_bundles, Assignment(graph->size())};
+    }
+
+    placed_bundles = results[winner].placed_bundles;
+    return results[winner];
+}
@@ -0,0 +1,152 @@
+#include "solvers.h"
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <unordered_map>
+
+
+SolverConfig make_region_config(const SolverConfig& base, double time_budget) {
+    SolverConfig cfg = base;
+    cfg.num_threads = 1;
+    cfg.verbose = false;
+    cfg.parallel_backtracking = false;
+    // Таблица транспозиций на каждый регион - не больше 64К записей
+    cfg.tt_size_log2 = std::min(base.tt_size_log2, 16);
+    if (base.max_time_seconds > 0.001) {
+        cfg.max_time_seconds = std::max(0.002, time_budget);
+    }
+    return cfg;
+}
+
+RegionSolution solve_region(const Grid& grid, const std::vector<int>& cells,
+                            const std::vector<Bundle>& bundles, const SolverConfig& cfg,
+                            float must_beat) {
+    RegionSolution result;
+    result.cell_bundle.assign(cells.size(), -1);
+    result.cell_figure.assign(cells.size(), -1);
+    if (cells.empty() || bundles.empty()) return result;
+
+    Puzzle sub(grid.extract_subgrid(cells), bundles, "Region");
+    GRASPSolver solver(sub, cfg);
+    if (must_beat >= 0.0f) {
+        auto shared = std::make_shared<SharedIncumbent>();
+        shared->offer(must_beat);
+        solver.share_incumbent(shared);
+    }
+    SolverResult r = solver.solve();
+
+    result.score = r.score;
+    result.placed = r.placed_bundles;
+    result.cell_bundle = std::move(r.assignment.bundle_id);
+    result.cell_figure = std::move(r.assignment.figure_id);
+    return result;
+}
+
+void PartialSolution::commit(const std::vector<int>& cells, const RegionSolution& region) {
+    int max_local_figure = -1;
+    for (size_t i = 0; i < cells.size(); ++i) {
+        int gid = cells[i];
+        cell_bundle[gid] = region.cell_bundle[i];
+        cell_figure[gid] = region.cell_figure[i] == -1 ? -1 : next_figure_id + region.cell_figure[i];
+        max_local_figure = std::max(max_local_figure, region.cell_figure[i]);
+    }
+    next_figure_id += max_local_figure + 1;
+}
+
+SolverResult PartialSolution::to_result() const {
+    SolverResult result{0.0f, {}, {}};
+    result.assignment.bundle_id = cell_bundle;
+    result.assignment.figure_id = cell_figure;
+    std::vector<int> seen_ids;
+    for (size_t nid = 0; nid < cell_bundle.size(); ++nid) {
+        int bid = cell_bundle[nid];
+        if (bid == -1) continue;
+        result.score += 1.0f;
+        if (bid >= (int)seen_ids.size()) seen_ids.resize(bid + 1, 0);
+        if (!seen_ids[bid]) {
+            seen_ids[bid] = 1;
+            result.placed_bundles.push_back(bid);
+        }
+    }
+    return result;
+}
+
+// Совпадают ли клетки фигуры (отсортированные) с каким-либо вложением формы shape
+static bool matches_shape(const Grid& grid, const std::vector<int>& cells, const std::shared_ptr<Figure>& shape) {
+    if (shape->size() != cells.size()) return false;
+    for (int anchor : cells) {
+        for (int rot = 0; rot < (int)grid.get_max_ports(); ++rot) {
+            std::vector<int> footprint = grid.get_embedding(shape, anchor, rot);
+            if (footprint.empty()) continue;
+            std::sort(footprint.begin(), footprint.end());
+            if (footprint == cells) return true;
+        }
+    }
+    return false;
+}
+
+PartialSolution load_warm_start(const Grid& grid, const std::vector<Bundle>& bundles,
+                                const Puzzle& prior, std::vector<int>& dirty) {
+    PartialSolution solution(grid.size());
+    dirty.clear();
+    const Assignment& old = prior.get_assignment();
+
+    std::unordered_map<long long, int> prior_at; // координаты -> клетка prior
+    for (const auto& node : prior.get_grid()->get_nodes()) {
+        const GridCellData& d = node.get_data();
+        prior_at[((long long)d.y << 32) | (unsigned)d.x] = node.get_id();
+    }
+
+    // Клетки прежнего решения по бандлам и фигурам: bundle_id -> figure_id -> клетки grid
+    std::map<int, std::map<int, std::vector<int>>> placed;
+    for (const auto& node : grid.get_nodes()) {
+        const GridCellData& d = node.get_data();
+        auto it = prior_at.find(((long long)d.y << 32) | (unsigned)d.x);
+        if (it == prior_at.end()) {
+            dirty.push_back(node.get_id());
+            continue;
+        }
+        int old_bundle = old.bundle_id[it->second];
+        if (old_bundle != -1) placed[old_bundle][old.figure_id[it->second]].push_back(node.get_id());
+    }
+
+    std::unordered_map<int, int> index_of; // id бандла -> индекс в bundles
+    for (size_t i = 0; i < bundles.size(); ++i) index_of[bundles[i].get_id()] = (int)i;
+
+    for (auto& [bid, figures] : placed) {
+        auto it = index_of.find(bid);
+        bool valid = it != index_of.end() && figures.size() == bundles[it->second].get_shapes().size();
+
+        // Каждой фигуре - своя форма бандла
+        if (valid) {
+            const auto& shapes = bundles[it->second].get_shapes();
+            std::vector<char> used(shapes.size(), 0);
+            for (auto& [fid, cells] : figures) {
+                std::sort(cells.begin(), cells.end());
+                bool found = false;
+                for (size_t s = 0; s < shapes.size() && !found; ++s) {
+                    if (used[s] || !matches_shape(grid, cells, shapes[s])) continue;
+                    used[s] = 1;
+                    found = true;
+                }
+                if (!found) {
+                    valid = false;
+                    break;
+                }
+            }
+        }
+
+        for (auto& [fid, cells] : figures) {
+            if (!valid) {
+                dirty.insert(dirty.end(), cells.begin(), cells.end());
+                continue;
+            }
+            for (int c : cells) {
+                solution.cell_bundle[c] = bid;
+                solution.cell_figure[c] = solution.next_figure_id;
+            }
+            solution.next_figure_id++;
+        }
+    }
+    return solution;
+}
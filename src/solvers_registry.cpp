@@ -0,0 +1,33 @@
+#include "solvers.h"
+
+
+SolverRegistry& SolverRegistry::instance() {
+    static SolverRegistry registry = [] {
+        SolverRegistry r;
+        r.add("grasp", [](const Puzzle& p, const SolverConfig& cfg) { return std::make_unique<GRASPSolver>(p, cfg); });
+        r.add("tiled", [](const Puzzle& p, const SolverConfig& cfg) { return std::make_unique<TiledSolver>(p, cfg); });
+        r.add("multilevel", [](const Puzzle& p, const SolverConfig& cfg) { return std::make_unique<MultilevelSolver>(p, cfg); });
+        r.add("lns", [](const Puzzle& p, const SolverConfig& cfg) { return std::make_unique<LNSSolver>(p, cfg); });
+        r.add("beam", [](const Puzzle& p, const SolverConfig& cfg) { return std::make_unique<BeamSolver>(p, cfg); });
+        r.add("portfolio", [](const Puzzle& p, const SolverConfig& cfg) { return std::make_unique<PortfolioSolver>(p, cfg); });
+        return r;
+    }();
+    return registry;
+}
+
+void SolverRegistry::add(const std::string& name, Factory factory) {
+    factories[name] = std::move(factory);
+}
+
+std::unique_ptr<Solver> SolverRegistry::create(const std::string& name, const Puzzle& p,
+                                               const SolverConfig& cfg) const {
+    auto it = factories.find(name);
+    if (it == factories.end()) return nullptr;
+    return it->second(p, cfg);
+}
+
+std::vector<std::string> SolverRegistry::names() const {
+    std::vector<std::string> result;
+    for (const auto& [name, factory] : factories) result.push_back(name);
+    return result;
+}
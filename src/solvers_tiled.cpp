@@ -0,0 +1,194 @@
+#include "solvers.h"
+#include <iostream>
+#include <algorithm>
+#include <vector>
+#include <queue>
+#include <chrono>
+
+
+SolverResult TiledSolver::solve() {
+    auto start_time = std::chrono::high_resolution_clock::now();
+    auto elapsed = [&]() {
+        std::chrono::duration<double> d = std::chrono::high_resolution_clock::now() - start_time;
+        return d.count();
+    };
+    bool use_timer = (config.max_time_seconds > 0.001);
+    int num_threads = std::max(1, config.num_threads);
+    int tile = std::max(1, config.tile_size);
+    int seam = std::max(1, std::min(config.seam_width, tile / 4));
+
+    PartialSolution solution(graph->size());
+
+    // 1. Нарезка поля на тайлы по координатам клеток. Полосы шириной 2*seam вдоль
+    // внутренних швов в тайлы не входят: их заполняет этап досборки.
+    int tiles_x = (graph->get_width() + tile - 1) / tile;
+    int tiles_y = (graph->get_height() + tile - 1) / tile;
+    auto in_seam_band = [&](int coord, int tiles) {
+        int k = (coord + seam) / tile;
+        return k >= 1 && k < tiles && coord >= k * tile - seam && coord < k * tile + seam;
+    };
+
+    std::vector<std::vector<int>> tile_cells(std::max(1, tiles_x * tiles_y));
+    for (const auto& node : graph->get_nodes()) {
+        const GridCellData& d = node.get_data();
+        if (in_seam_band(d.x, tiles_x) || in_seam_band(d.y, tiles_y)) continue;
+        int t = std::min(d.y / tile, tiles_y - 1) * tiles_x + std::min(d.x / tile, tiles_x - 1);
+        tile_cells[t].push_back(node.get_id());
+    }
+    // Наибольшая площадь подзадачи (тайла или отрезка шва): в глобальный проход идут
+    // только бандлы крупнее нее
+    long long largest = 0;
+    for (const auto& cells : tile_cells) largest = std::max(largest, (long long)cells.size());
+
+    // 2. Распределение бандлов: от крупных к мелким, в тайл с наибольшим остатком площади
+    std::vector<int> order(bundles.size());
+    for (size_t i = 0; i < bundles.size(); ++i) order[i] = (int)i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return bundles[a].get_total_area() > bundles[b].get_total_area();
+    });
+
+    std::vector<std::vector<int>> tile_bundles(tile_cells.size());
+    std::vector<int> leftovers;
+    std::priority_queue<std::pair<long long, int>> capacity;
+    for (size_t t = 0; t < tile_cells.size(); ++t) {
+        capacity.push({(long long)tile_cells[t].size(), (int)t});
+    }
+    for (int bi : order) {
+        auto [left, t] = capacity.top();
+        long long area = (long long)bundles[bi].get_total_area();
+        if (left < area) {
+            leftovers.push_back(bi);
+            continue;
+        }
+        capacity.pop();
+        tile_bundles[t].push_back(bi);
+        capacity.push({left - area, t});
+    }
+
+    if (config.verbose) {
+        std::cout << "Tiled: " << tiles_x << "x" << tiles_y << " тайлов по " << tile
+                  << ", бандлов на швы: " << leftovers.size() << std::endl;
+    }
+
+    WorkStealingPool workers(num_threads);
+
+    // Параллельно решает набор непересекающихся регионов и переносит результаты в решение.
+    // Бандлы, которые не удалось разместить, возвращаются в leftovers.
+    auto solve_regions = [&](const std::vector<std::vector<int>>& region_cells,
+                             const std::vector<std::vector<int>>& region_bundles,
+                             double time_budget) {
+        int waves = (int)((region_cells.size() + num_threads - 1) / num_threads);
+        SolverConfig cfg = make_region_config(config, waves > 0 ? time_budget / waves : 0.0);
+
+        std::vector<RegionSolution> results(region_cells.size());
+        {
+            TaskGroup group(workers);
+            for (size_t r = 0; r < region_cells.size(); ++r) {
+                if (region_bundles[r].empty()) continue;
+                group.inject([&, r]() {
+                    std::vector<Bundle> subset;
+                    for (int bi : region_bundles[r]) subset.push_back(bundles[bi]);
+                    results[r] = solve_region(*graph, region_cells[r], subset, cfg);
+                });
+            }
+            group.wait();
+        }
+
+        for (size_t r = 0; r < region_cells.size(); ++r) {
+            if (region_bundles[r].empty()) continue;
+            solution.commit(region_cells[r], results[r]);
+            for (int bi : region_bundles[r]) {
+                if (std::find(results[r].placed.begin(), results[r].placed.end(), bundles[bi].get_id())
+                        == results[r].placed.end()) {
+                    leftovers.push_back(bi);
+                }
+            }
+        }
+    };
+
+    // 3. Параллельное решение тайлов
+    solve_regions(tile_cells, tile_bundles, use_timer ? 0.6 * config.max_time_seconds : 0.0);
+
+    // 4. Досборка вдоль швов: сначала вертикальные, затем горизонтальные.
+    // Регион - свободные клетки в окне шириной 4*seam вокруг шва (полоса + дыры краев тайлов),
+    // нарезанном на отрезки длиной в тайл, чтобы размер подзадачи не зависел от размеров поля.
+    // Отрезки одной фазы не пересекаются и решаются параллельно; занятые клетки не трогаются,
+    // поэтому досборка только добавляет бандлы.
+    int window = 2 * seam;
+    for (int phase = 0; phase < 2 && !leftovers.empty() && !stop_requested(); ++phase) {
+        int seam_lines = (phase == 0) ? tiles_x - 1 : tiles_y - 1;
+        int segments = (phase == 0) ? tiles_y : tiles_x;
+        if (seam_lines <= 0) continue;
+
+        std::vector<std::vector<int>> strip_cells(seam_lines * segments);
+        for (const auto& node : graph->get_nodes()) {
+            int nid = node.get_id();
+            if (solution.cell_bundle[nid] != -1) continue;
+            const GridCellData& d = node.get_data();
+            int coord = (phase == 0) ? d.x : d.y;
+            int along = (phase == 0) ? d.y : d.x;
+            int line = (coord + window) / tile - 1;
+            if (line < 0 || line >= seam_lines) continue;
+            int seam_pos = (line + 1) * tile;
+            if (coord < seam_pos - window || coord >= seam_pos + window) continue;
+            strip_cells[line * segments + std::min(along / tile, segments - 1)].push_back(nid);
+        }
+        for (const auto& cells : strip_cells) largest = std::max(largest, (long long)cells.size());
+
+        // Оставшиеся бандлы раздаем отрезкам по свободной площади
+        std::sort(leftovers.begin(), leftovers.end(), [&](int a, int b) {
+            return bundles[a].get_total_area() > bundles[b].get_total_area();
+        });
+        std::vector<std::vector<int>> strip_bundles(strip_cells.size());
+        std::vector<int> unassigned;
+        std::priority_queue<std::pair<long long, int>> strip_capacity;
+        for (size_t s = 0; s < strip_cells.size(); ++s) {
+            strip_capacity.push({(long long)strip_cells[s].size(), (int)s});
+        }
+        for (int bi : leftovers) {
+            auto [left, s] = strip_capacity.top();
+            long long area = (long long)bundles[bi].get_total_area();
+            if (left < area) {
+                unassigned.push_back(bi);
+                continue;
+            }
+            strip_capacity.pop();
+            strip_bundles[s].push_back(bi);
+            strip_capacity.push({left - area, s});
+        }
+        leftovers = unassigned;
+
+        double phase_budget = use_timer ? std::max(0.0, config.max_time_seconds - elapsed()) / (2 - phase) : 0.0;
+        solve_regions(strip_cells, strip_bundles, phase_budget);
+    }
+
+    // 5. Глобальный проход для бандлов крупнее любого тайла и отрезка шва: ни в одной
+    // подзадаче им не хватило бы места. Остальные неразмещенные бандлы не ставятся -
+    // иначе подзадача размером в поле вернула бы время, зависящее от площади поля.
+    std::vector<std::vector<int>> oversized(1);
+    leftovers.erase(std::remove_if(leftovers.begin(), leftovers.end(), [&](int bi) {
+        if ((long long)bundles[bi].get_total_area() <= largest) return false;
+        oversized[0].push_back(bi);
+        return true;
+    }), leftovers.end());
+    if (!oversized[0].empty() && !stop_requested()) {
+        std::vector<std::vector<int>> free_cells(1);
+        for (const auto& node : graph->get_nodes()) {
+            if (solution.cell_bundle[node.get_id()] == -1) free_cells[0].push_back(node.get_id());
+        }
+        solve_regions(free_cells, oversized, use_timer ? std::max(0.0, config.max_time_seconds - elapsed()) : 0.0);
+    } else {
+        leftovers.insert(leftovers.end(), oversized[0].begin(), oversized[0].end());
+    }
+
+    // 6. Итог: запись в сетку
+    SolverResult result = solution.to_result();
+    placed_bundles = result.placed_bundles;
+
+    if (config.verbose) {
+        std::cout << "Tiled: не размещено бандлов: " << leftovers.size()
+                  << ", время: " << elapsed() << " сек." << std::endl;
+    }
+
+    return result;
+}